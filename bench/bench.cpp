@@ -0,0 +1,292 @@
+// Benchmark reproduzível da carga e das consultas prefix, user, tags e top.
+//
+// Carrega movies.csv, ratings.csv e tags.csv de DIR (gerados por tools/gen_movielens.cpp ou
+// os do MovieLens) e mede:
+//   - a carga de cada arquivo em linhas/s (loadRatings, ou loadRatingsParallel com --threads)
+//     e a montagem dos índices;
+//   - Q consultas de cada tipo, cronometradas uma a uma, com p50/p99/máximo:
+//       prefix: 1 a 4 primeiros caracteres de um título sorteado (TitleTrie::searchPrefix);
+//       user:   metade usuários sorteados entre todos, metade entre o 1% com mais
+//               avaliações (trecho do CSR ordenado em queryUser);
+//       tags:   1 a 3 tags, as mais frequentes com mais chance (interseção de queryTags);
+//       top:    N de 10 ou 100 em um gênero sorteado (varredura de queryTop);
+//   - o pico de memória (VmHWM) de cada fase. O pico é zerado antes de cada fase escrevendo
+//     "5" em /proc/self/clear_refs; se o kernel não permitir, o pico mostrado é acumulado.
+//
+// Os arquivos são lidos uma vez antes da carga para contar as linhas, então a carga mede o
+// parse com os dados já no cache de páginas. As consultas são sorteadas com --seed
+// (mt19937, só a saída crua do gerador), então a mesma semente repete a mesma carga de trabalho.
+// A saída das consultas passa pelo TableSink e é descartada.
+//
+// Uso:
+//   bench DIR [--threads N] [--queries Q] [--seed S]
+//
+// Compilar (na raiz do projeto):
+//   g++ -std=c++17 -O2 -pthread -Iinclude bench/bench.cpp $(ls src/*.cpp | grep -v '/main.cpp') -o bench
+//
+// bench/run_bench.sh gera os dados nas escalas pedidas e roda este benchmark em cada uma.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "data_loader.hpp"
+#include "queries.hpp"
+#include "sort_utils.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Descarta tudo o que for escrito
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+struct Memory {
+    double rssMiB = 0.0;
+    double peakMiB = 0.0;
+};
+
+Memory readMemory() {
+    Memory m;
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) m.rssMiB = std::atof(line.c_str() + 6) / 1024.0;
+        if (line.compare(0, 6, "VmHWM:") == 0) m.peakMiB = std::atof(line.c_str() + 6) / 1024.0;
+    }
+    return m;
+}
+
+// Zera o VmHWM (Linux 4.0+); false se não for possível
+bool resetPeak() {
+    std::FILE* f = std::fopen("/proc/self/clear_refs", "w");
+    if (!f) return false;
+    bool ok = std::fputs("5", f) >= 0;
+    return std::fclose(f) == 0 && ok;
+}
+
+// Linhas de dados (sem o cabeçalho); -1 se o arquivo não abrir
+long countRows(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return -1;
+    char buf[1 << 16];
+    long lines = 0;
+    std::size_t n;
+    char last = '\n';
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) {
+        for (std::size_t i = 0; i < n; ++i) lines += buf[i] == '\n';
+        last = buf[n - 1];
+    }
+    std::fclose(f);
+    if (last != '\n') ++lines;
+    return lines > 0 ? lines - 1 : 0;
+}
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Uma fase de carga: tempo, linhas/s e memória
+void loadPhase(const char* name, long rows, const std::function<void()>& fn) {
+    resetPeak();
+    Clock::time_point start = Clock::now();
+    fn();
+    double ms = elapsedMs(start);
+    Memory mem = readMemory();
+    if (rows >= 0) {
+        std::printf("%-10s %10ld %10.1f %12.0f %10.1f %10.1f\n", name, rows, ms,
+                    rows / (ms / 1000.0), mem.rssMiB, mem.peakMiB);
+    } else {
+        std::printf("%-10s %10s %10.1f %12s %10.1f %10.1f\n", name, "-", ms, "-", mem.rssMiB, mem.peakMiB);
+    }
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    return sorted[static_cast<std::size_t>(p * (sorted.size() - 1) + 0.5)];
+}
+
+// Roda run(i) para cada consulta, cronometrando uma a uma
+void queryPhase(const char* name, std::size_t count, const std::function<void(std::size_t)>& run) {
+    // Aquecimento fora da medição
+    for (std::size_t i = 0; i < count && i < 100; ++i) run(i);
+
+    resetPeak();
+    std::vector<double> micros(count);
+    Clock::time_point phaseStart = Clock::now();
+    for (std::size_t i = 0; i < count; ++i) {
+        Clock::time_point start = Clock::now();
+        run(i);
+        micros[i] = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+    double ms = elapsedMs(phaseStart);
+    Memory mem = readMemory();
+
+    sort_utils::quickSort(micros, [](double a, double b) { return a < b; });
+    std::printf("%-10s %10zu %10.1f %12.0f %10.1f %10.1f %10.1f %10.1f\n", name, count, ms,
+                count / (ms / 1000.0), percentile(micros, 0.50), percentile(micros, 0.99),
+                micros.empty() ? 0.0 : micros.back(), mem.peakMiB);
+}
+
+void usage(const char* argv0) {
+    std::fprintf(stderr, "usage: %s DIR [--threads N] [--queries Q] [--seed S]\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string dir;
+    unsigned threads = 1;
+    std::size_t queryCount = 10000;
+    unsigned seed = 7;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--queries" && i + 1 < argc) {
+            queryCount = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (!arg.empty() && arg[0] != '-' && dir.empty()) {
+            dir = arg;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (dir.empty() || threads == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::string moviesPath = dir + "/movies.csv";
+    std::string ratingsPath = dir + "/ratings.csv";
+    std::string tagsPath = dir + "/tags.csv";
+    long movieRows = countRows(moviesPath);
+    long ratingRows = countRows(ratingsPath);
+    long tagRows = countRows(tagsPath);
+    if (movieRows < 0 || ratingRows < 0) {
+        std::fprintf(stderr, "cannot read %s and %s\n", moviesPath.c_str(), ratingsPath.c_str());
+        return 1;
+    }
+
+    if (!resetPeak()) std::printf("note: cannot reset VmHWM, peaks are cumulative\n");
+    std::printf("%s, %u thread(s), %zu queries per command, seed %u\n\n", dir.c_str(), threads, queryCount, seed);
+
+    DataContext ctx;
+    std::printf("%-10s %10s %10s %12s %10s %10s\n", "load", "rows", "ms", "rows/s", "rss MiB", "peak MiB");
+    loadPhase("movies", movieRows, [&] { data_loader::loadMovies(moviesPath, ctx); });
+    loadPhase("ratings", ratingRows, [&] {
+        if (threads > 1) data_loader::loadRatingsParallel(ratingsPath, ctx, threads);
+        else data_loader::loadRatings(ratingsPath, ctx);
+    });
+    loadPhase("tags", tagRows, [&] { data_loader::loadTags(tagsPath, ctx); });
+    loadPhase("indexes", -1, [&] { data_loader::buildIndexes(ctx); });
+    std::printf("\n");
+
+    if (ctx.movies.size() == 0) {
+        std::fprintf(stderr, "no movies loaded\n");
+        return 1;
+    }
+
+    // Cargas de trabalho sorteadas antes da medição
+    std::mt19937 rng(seed);
+
+    std::vector<std::string> prefixes(queryCount);
+    for (std::string& p : prefixes) {
+        std::string_view title = ctx.movies.title(static_cast<int>(rng() % ctx.movies.size()));
+        p = std::string(title.substr(0, 1 + rng() % 4));
+    }
+
+    // Usuários pesados: o 1% com mais avaliações (pelo menos um)
+    struct UserCount {
+        int user;
+        std::size_t ratings;
+    };
+    std::vector<UserCount> userCounts;
+    userCounts.reserve(ctx.users.size());
+    for (std::size_t u = 0; u < ctx.users.size(); ++u) {
+        userCounts.push_back(UserCount{static_cast<int>(u), ctx.users.ratings(static_cast<int>(u)).size});
+    }
+    sort_utils::quickSort(userCounts, [](const UserCount& a, const UserCount& b) {
+        if (a.ratings != b.ratings) return a.ratings > b.ratings;
+        return a.user < b.user;
+    });
+    std::size_t heavyUsers = userCounts.size() / 100 > 0 ? userCounts.size() / 100 : 1;
+    std::vector<int> userQueries(userCounts.empty() ? 0 : queryCount);
+    for (int& q : userQueries) {
+        int user = rng() % 2 == 0 ? userCounts[rng() % heavyUsers].user
+                                  : static_cast<int>(rng() % userCounts.size());
+        q = ctx.users.userId(user);
+    }
+
+    // Tags da mais para a menos frequente; o sorteio favorece o começo (posição ~ n·u³)
+    struct TagCount {
+        std::string tag;
+        std::size_t movies;
+    };
+    std::vector<TagCount> tagCounts;
+    ctx.tags.forEach([&](std::string_view tag, const TagEntry& entry) {
+        tagCounts.push_back(TagCount{std::string(tag), ctx.tags.movieCount(entry)});
+    });
+    sort_utils::quickSort(tagCounts, [](const TagCount& a, const TagCount& b) {
+        if (a.movies != b.movies) return a.movies > b.movies;
+        return a.tag < b.tag;
+    });
+    std::vector<std::vector<queries::TagToken>> tagQueries(tagCounts.empty() ? 0 : queryCount);
+    for (std::vector<queries::TagToken>& q : tagQueries) {
+        std::size_t n = 1 + rng() % 3;
+        for (std::size_t k = 0; k < n; ++k) {
+            double u = static_cast<double>(rng()) / 4294967296.0;
+            q.push_back(queries::TagToken{tagCounts[static_cast<std::size_t>(u * u * u * tagCounts.size())].tag, true});
+        }
+    }
+
+    const std::vector<std::string>& genres = ctx.movies.genreNames();
+    struct TopQuery {
+        int n;
+        std::string genre;
+    };
+    std::vector<TopQuery> topQueries(genres.empty() ? 0 : queryCount);
+    for (TopQuery& q : topQueries) {
+        q.n = rng() % 2 == 0 ? 10 : 100;
+        q.genre = genres[rng() % genres.size()];
+    }
+
+    NullBuffer nullBuffer;
+    std::ostream discard(&nullBuffer);
+
+    std::printf("%-10s %10s %10s %12s %10s %10s %10s %10s\n",
+                "query", "count", "ms", "queries/s", "p50 us", "p99 us", "max us", "peak MiB");
+    queryPhase("prefix", prefixes.size(), [&](std::size_t i) {
+        TableSink sink(discard);
+        queries::queryPrefix(ctx, sink, prefixes[i]);
+        sink.endResult();
+    });
+    queryPhase("user", userQueries.size(), [&](std::size_t i) {
+        TableSink sink(discard);
+        queries::queryUser(ctx, sink, userQueries[i]);
+        sink.endResult();
+    });
+    queryPhase("tags", tagQueries.size(), [&](std::size_t i) {
+        TableSink sink(discard);
+        queries::queryTags(ctx, sink, tagQueries[i]);
+        sink.endResult();
+    });
+    queryPhase("top", topQueries.size(), [&](std::size_t i) {
+        TableSink sink(discard);
+        queries::queryTop(ctx, sink, topQueries[i].n, topQueries[i].genre);
+        sink.endResult();
+    });
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Micro-benchmark da interseção de listas de tags (queryTags).
+//
+// Compara a interseção antiga (varredura linear de cada lista para cada id da menor)
+// com intersect::intersectAll sobre listas ordenadas, em pares de tamanhos parecidos
+// e em pares bem desbalanceados.
+//
+// Compilar (na raiz do projeto):
+//   g++ -std=c++17 -O2 -Iinclude bench/intersect_bench.cpp src/intersect.cpp src/sort_utils.cpp -o intersect_bench
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "intersect.hpp"
+
+namespace {
+
+// Lista ordenada com n ids distintos sorteados em [0, universe)
+std::vector<int> makeList(std::size_t n, int universe, std::mt19937& rng) {
+    std::vector<char> used(static_cast<std::size_t>(universe), 0);
+    std::uniform_int_distribution<int> dist(0, universe - 1);
+    std::size_t added = 0;
+    while (added < n) {
+        int id = dist(rng);
+        if (!used[id]) {
+            used[id] = 1;
+            ++added;
+        }
+    }
+    std::vector<int> out;
+    out.reserve(n);
+    for (int id = 0; id < universe; ++id) {
+        if (used[id]) out.push_back(id);
+    }
+    return out;
+}
+
+// Algoritmo anterior de queryTags
+void legacyIntersect(const std::vector<const std::vector<int>*>& lists, std::vector<int>& out) {
+    out.clear();
+    std::size_t smallestIdx = 0;
+    for (std::size_t i = 1; i < lists.size(); ++i) {
+        if (lists[i]->size() < lists[smallestIdx]->size()) smallestIdx = i;
+    }
+    for (int id : *lists[smallestIdx]) {
+        bool inAll = true;
+        for (std::size_t j = 0; j < lists.size() && inAll; ++j) {
+            if (j == smallestIdx) continue;
+            bool found = false;
+            for (int other : *lists[j]) {
+                if (other == id) {
+                    found = true;
+                    break;
+                }
+            }
+            inAll = found;
+        }
+        if (inAll) out.push_back(id);
+    }
+}
+
+template <typename Fn>
+double microsPerCall(Fn fn, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    const int universe = 60000;
+
+    struct Case {
+        const char* name;
+        std::vector<std::size_t> sizes;
+    };
+    std::vector<Case> cases = {
+        {"similar 2k x 2k", {2000, 2000}},
+        {"similar 8k x 6k", {8000, 6000}},
+        {"skewed 50 x 20k", {50, 20000}},
+        {"skewed 300 x 10k", {300, 10000}},
+        {"3 lists 4k x 3k x 500", {4000, 3000, 500}},
+    };
+
+    std::printf("%-24s %12s %12s %10s %8s\n", "case", "legacy us", "new us", "speedup", "matches");
+
+    for (const Case& c : cases) {
+        std::vector<std::vector<int>> data;
+        for (std::size_t n : c.sizes) data.push_back(makeList(n, universe, rng));
+
+        std::vector<const std::vector<int>*> lists;
+        for (const auto& d : data) lists.push_back(&d);
+
+        std::vector<int> legacyOut, newOut;
+        double legacy = microsPerCall([&] { legacyIntersect(lists, legacyOut); }, 20);
+        double fast = microsPerCall([&] { intersect::intersectAll(lists, newOut); }, 2000);
+
+        if (legacyOut != newOut) {
+            std::printf("%-24s MISMATCH\n", c.name);
+            return 1;
+        }
+        std::printf("%-24s %12.1f %12.2f %9.0fx %8zu\n", c.name, legacy, fast, legacy / fast, newOut.size());
+    }
+    return 0;
+}
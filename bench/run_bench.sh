@@ -0,0 +1,38 @@
+#!/bin/sh
+# Gera os dados sintéticos (tools/gen_movielens.cpp) e roda bench/bench.cpp em cada escala:
+# para cada uma, a carga de movies, ratings e tags e as consultas prefix, user, tags e top.
+#
+# Uso (na raiz do projeto):
+#   bench/run_bench.sh [ESCALA...]        padrão: 1 10
+#
+# Variáveis de ambiente:
+#   OUT      diretório dos binários e dos dados (padrão /tmp/ms_bench); os dados de cada
+#            escala ficam em OUT/scale-S e só são gerados se ainda não existirem
+#   THREADS  threads da carga de ratings (padrão 1)
+#   QUERIES  consultas de cada tipo (padrão 10000)
+#   SEED     semente do gerador e das consultas (padrão 42)
+#
+# A escala 100 gera 100M de avaliações (~2,5 GB de CSV) e precisa de vários GB de memória.
+set -e
+
+OUT=${OUT:-/tmp/ms_bench}
+THREADS=${THREADS:-1}
+QUERIES=${QUERIES:-10000}
+SEED=${SEED:-42}
+CXX=${CXX:-g++}
+
+mkdir -p "$OUT"
+SOURCES=$(ls src/*.cpp | grep -v '/main.cpp')
+$CXX -std=c++17 -O2 -Iinclude tools/gen_movielens.cpp -o "$OUT/gen_movielens"
+$CXX -std=c++17 -O2 -pthread -Iinclude bench/bench.cpp $SOURCES -o "$OUT/bench"
+
+[ $# -eq 0 ] && set -- 1 10
+for scale in "$@"; do
+    data="$OUT/scale-$scale"
+    if [ ! -f "$data/tags.csv" ]; then
+        mkdir -p "$data"
+        "$OUT/gen_movielens" --scale "$scale" --seed "$SEED" "$data"
+    fi
+    echo
+    "$OUT/bench" "$data" --threads "$THREADS" --queries "$QUERIES" --seed "$SEED"
+done
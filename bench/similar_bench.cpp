@@ -0,0 +1,156 @@
+// Micro-benchmark do núcleo da consulta similar.
+//
+// Mede o custo de comparar um filme com todos os candidatos (60k filmes, 30k usuários,
+// tamanhos de vetor com cauda longa) de três jeitos:
+//   - interseção das listas ordenadas de avaliadores, candidato a candidato (merge escalar);
+//   - vetor do filme espalhado em um array denso por usuário e produto escalar sobre os
+//     avaliadores de cada candidato, com os desvios calculados na hora a partir das notas e
+//     das médias (similarity::sparseDotScalar);
+//   - o mesmo com similarity::sparseDot (gathers AVX2 quando compilado com -mavx2).
+//
+// Compilar (na raiz do projeto), com e sem -mavx2:
+//   g++ -std=c++17 -O2 -mavx2 -pthread -Iinclude bench/similar_bench.cpp src/similarity.cpp src/centered_ratings.cpp src/movie_ratings.cpp src/users.cpp src/movie.cpp src/string_arena.cpp src/thread_pool.cpp src/sort_utils.cpp -o similar_bench
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "similarity.hpp"
+
+namespace {
+
+const int kMovies = 60000;
+const int kUsers = 30000;
+
+// Vetores esparsos por filme: avaliadores em ordem crescente, a nota em meias estrelas e o
+// desvio de cada um (nota - média do usuário), este só para o merge e para espalhar o alvo
+struct Vectors {
+    std::vector<std::uint64_t> offsets{0};
+    std::vector<std::int32_t> users;
+    std::vector<std::uint8_t> codes;
+    std::vector<float> devs;
+    std::vector<float> means;
+};
+
+Vectors makeVectors(std::mt19937& rng) {
+    Vectors v;
+    std::vector<char> used(kUsers, 0);
+    std::uniform_int_distribution<int> user(0, kUsers - 1);
+    std::uniform_int_distribution<int> code(1, 10);
+    std::uniform_real_distribution<float> mean(2.0f, 4.5f);
+    v.means.resize(kUsers);
+    for (float& m : v.means) m = mean(rng);
+    for (int m = 0; m < kMovies; ++m) {
+        // Poucos filmes muito avaliados, muitos com poucas avaliações
+        std::size_t n = static_cast<std::size_t>(3 + 20000.0 / std::pow(m + 1.0, 0.8));
+        std::fill(used.begin(), used.end(), 0);
+        for (std::size_t i = 0; i < n; ++i) used[user(rng)] = 1;
+        for (int u = 0; u < kUsers; ++u) {
+            if (!used[u]) continue;
+            std::uint8_t c = static_cast<std::uint8_t>(code(rng));
+            v.users.push_back(u);
+            v.codes.push_back(c);
+            v.devs.push_back(static_cast<float>(c) * 0.5f - v.means[u]);
+        }
+        v.offsets.push_back(v.users.size());
+    }
+    return v;
+}
+
+// Produto escalar por merge das duas listas ordenadas
+float mergeDot(const Vectors& v, int a, int b, std::uint32_t& common) {
+    std::uint64_t i = v.offsets[a], iEnd = v.offsets[a + 1];
+    std::uint64_t j = v.offsets[b], jEnd = v.offsets[b + 1];
+    float dot = 0.0f;
+    common = 0;
+    while (i < iEnd && j < jEnd) {
+        if (v.users[i] < v.users[j]) {
+            ++i;
+        } else if (v.users[j] < v.users[i]) {
+            ++j;
+        } else {
+            dot += v.devs[i++] * v.devs[j++];
+            ++common;
+        }
+    }
+    return dot;
+}
+
+// Trecho do filme como a consulta similar o vê (sem avaliações repetidas)
+CenteredSpan span(const Vectors& v, int movie) {
+    CenteredSpan s;
+    std::uint64_t b = v.offsets[movie];
+    s.users = v.users.data() + b;
+    s.codes = v.codes.data() + b;
+    s.means = v.means.data();
+    s.size = v.offsets[movie + 1] - b;
+    return s;
+}
+
+template <typename Fn>
+double millisPerQuery(Fn fn, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    Vectors v = makeVectors(rng);
+    std::printf("%d movies, %d users, %zu ratings\n", kMovies, kUsers, v.users.size());
+#if defined(__AVX2__)
+    std::printf("sparseDot: AVX2\n\n");
+#else
+    std::printf("sparseDot: scalar (compile with -mavx2 for the AVX2 kernel)\n\n");
+#endif
+
+    std::printf("%-10s %8s %12s %12s %12s\n", "target", "raters", "merge ms", "scalar ms", "sparseDot ms");
+
+    std::vector<float> dense(kUsers), presence(kUsers);
+    for (int target : {0, 10, 1000, 30000}) {
+        float mergeSum = 0.0f, scalarSum = 0.0f, simdSum = 0.0f;
+
+        double merge = millisPerQuery([&] {
+            for (int c = 0; c < kMovies; ++c) {
+                std::uint32_t common = 0;
+                mergeSum += mergeDot(v, target, c, common) + common;
+            }
+        }, 3);
+
+        auto scatter = [&] {
+            std::fill(dense.begin(), dense.end(), 0.0f);
+            std::fill(presence.begin(), presence.end(), 0.0f);
+            for (std::uint64_t r = v.offsets[target]; r < v.offsets[target + 1]; ++r) {
+                dense[v.users[r]] = v.devs[r];
+                presence[v.users[r]] = 1.0f;
+            }
+        };
+
+        double scalar = millisPerQuery([&] {
+            scatter();
+            for (int c = 0; c < kMovies; ++c) {
+                std::uint32_t common = 0;
+                scalarSum += similarity::sparseDotScalar(dense.data(), presence.data(), span(v, c), common) + common;
+            }
+        }, 10);
+
+        double simd = millisPerQuery([&] {
+            scatter();
+            for (int c = 0; c < kMovies; ++c) {
+                std::uint32_t common = 0;
+                simdSum += similarity::sparseDot(dense.data(), presence.data(), span(v, c), common) + common;
+            }
+        }, 10);
+
+        std::printf("%-10d %8llu %12.2f %12.2f %12.2f   (checksums %.1f %.1f %.1f)\n", target,
+                    static_cast<unsigned long long>(v.offsets[target + 1] - v.offsets[target]),
+                    merge, scalar, simd, mergeSum / 3, scalarSum / 10, simdSum / 10);
+    }
+    return 0;
+}
@@ -0,0 +1,214 @@
+// Micro-benchmark de sort_utils::quickSort.
+//
+// Compara o quicksort antigo (pivô do meio copiado por valor, sem limite de profundidade),
+// o introsort atual de sort_utils e std::sort sobre os vetores que as consultas ordenam:
+// resultados com título/gêneros (prefix/tags), o ranking global (buildIndexes) e ids soltos
+// (listas de tags). Cada caso roda com entrada aleatória, já ordenada, invertida, com muitas
+// repetições e em "órgão" (sobe e desce).
+// No fim roda o adversário de McIlroy ("A killer adversary for quicksort"), que monta em tempo
+// real a entrada que faz cada ordenação comparar o máximo possível, e mostra quantas
+// comparações cada uma precisou.
+//
+// Compilar (na raiz do projeto):
+//   g++ -std=c++17 -O2 -Iinclude bench/sort_bench.cpp -o sort_bench
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sort_utils.hpp"
+
+namespace {
+
+// Cópia do quickSort que existia antes do introsort
+template <typename T, typename Comparator>
+void legacyQuickSort(std::vector<T>& arr, int left, int right, Comparator cmp) {
+    int i = left;
+    int j = right;
+    T pivot = arr[(left + right) / 2];
+
+    while (i <= j) {
+        while (cmp(arr[i], pivot)) i++;
+        while (cmp(pivot, arr[j])) j--;
+
+        if (i <= j) {
+            std::swap(arr[i], arr[j]);
+            i++;
+            j--;
+        }
+    }
+
+    if (left < j) legacyQuickSort(arr, left, j, cmp);
+    if (i < right) legacyQuickSort(arr, i, right, cmp);
+}
+
+template <typename T, typename Comparator>
+void legacyQuickSort(std::vector<T>& arr, Comparator cmp) {
+    if (arr.empty()) return;
+    legacyQuickSort(arr, 0, static_cast<int>(arr.size()) - 1, cmp);
+}
+
+// Mesmo formato de PrefixResult/TagResult em queries.cpp
+struct MovieResult {
+    int movieId;
+    std::string title;
+    std::string genres;
+    double avg;
+    int ratingCount;
+};
+
+// Mesmo formato do Ranked de buildIndexes
+struct Ranked {
+    int movieId;
+    double avg;
+    int ratingCount;
+};
+
+bool resultLess(const MovieResult& a, const MovieResult& b) {
+    if (a.avg != b.avg) return a.avg > b.avg;
+    if (a.ratingCount != b.ratingCount) return a.ratingCount > b.ratingCount;
+    return a.movieId < b.movieId;
+}
+
+bool rankedLess(const Ranked& a, const Ranked& b) {
+    if (a.avg != b.avg) return a.avg > b.avg;
+    if (a.ratingCount != b.ratingCount) return a.ratingCount > b.ratingCount;
+    return a.movieId < b.movieId;
+}
+
+enum class Shape { Random, Sorted, Reversed, FewValues, OrganPipe };
+
+const char* shapeName(Shape s) {
+    switch (s) {
+        case Shape::Random:    return "aleatorio";
+        case Shape::Sorted:    return "ordenado";
+        case Shape::Reversed:  return "invertido";
+        case Shape::FewValues: return "repetidos";
+        case Shape::OrganPipe: return "orgao";
+    }
+    return "?";
+}
+
+// Chaves de ordenação (média, contagem) para n filmes no formato pedido.
+// As médias são meias estrelas como no MovieLens; em FewValues só existem 4 médias distintas.
+std::vector<Ranked> makeKeys(std::size_t n, Shape shape, std::mt19937& rng) {
+    std::vector<Ranked> keys(n);
+    std::uniform_int_distribution<int> half(1, 10);
+    std::uniform_int_distribution<int> count(1, 5000);
+    for (std::size_t i = 0; i < n; ++i) {
+        int h = shape == Shape::FewValues ? 6 + static_cast<int>(rng() % 4) : half(rng);
+        keys[i] = Ranked{static_cast<int>(i) + 1, h / 2.0, shape == Shape::FewValues ? 10 : count(rng)};
+    }
+
+    if (shape == Shape::Sorted || shape == Shape::Reversed || shape == Shape::OrganPipe) {
+        std::sort(keys.begin(), keys.end(), rankedLess);
+        if (shape == Shape::Reversed) std::reverse(keys.begin(), keys.end());
+        if (shape == Shape::OrganPipe) std::reverse(keys.begin() + n / 2, keys.end());
+    }
+    return keys;
+}
+
+std::vector<MovieResult> makeResults(const std::vector<Ranked>& keys, std::mt19937& rng) {
+    static const char* kGenres[] = {"Drama", "Comedy|Romance", "Action|Adventure|Sci-Fi", "Thriller|Crime"};
+    std::vector<MovieResult> out;
+    out.reserve(keys.size());
+    for (const Ranked& k : keys) {
+        std::string title = "Some Movie Title Number " + std::to_string(k.movieId) + " (19" +
+                            std::to_string(50 + rng() % 50) + ")";
+        out.push_back(MovieResult{k.movieId, title, std::string(kGenres[rng() % 4]) + ",1999", k.avg, k.ratingCount});
+    }
+    return out;
+}
+
+using Clock = std::chrono::steady_clock;
+
+template <typename T, typename Sorter>
+double timeSort(const std::vector<T>& input, int reps, Sorter sorter) {
+    double best = 1e300;
+    for (int r = 0; r < reps; ++r) {
+        std::vector<T> v = input;
+        auto t0 = Clock::now();
+        sorter(v);
+        auto t1 = Clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+    return best;
+}
+
+template <typename T, typename Comparator>
+void benchCase(const char* label, Shape shape, const std::vector<T>& input, int reps, Comparator cmp) {
+    double legacy = timeSort(input, reps, [&](std::vector<T>& v) { legacyQuickSort(v, cmp); });
+    double intro  = timeSort(input, reps, [&](std::vector<T>& v) { sort_utils::quickSort(v, cmp); });
+    double stdS   = timeSort(input, reps, [&](std::vector<T>& v) { std::sort(v.begin(), v.end(), cmp); });
+
+    std::printf("%-10s %8zu  %-10s  antigo %9.3f ms  introsort %9.3f ms  std::sort %9.3f ms\n",
+                label, input.size(), shapeName(shape), legacy, intro, stdS);
+}
+
+// Adversário de McIlroy: os elementos são índices em val; todos começam "gás" e só recebem
+// um valor definitivo quando o adversário precisa decidir uma comparação. O candidato a pivô
+// é congelado com o menor valor possível, o que empurra qualquer quicksort ao pior caso.
+struct Adversary {
+    std::vector<int> val;
+    int gas;
+    int nsolid = 0;
+    int candidate = 0;
+    long long comparisons = 0;
+
+    explicit Adversary(std::size_t n) : val(n, static_cast<int>(n)), gas(static_cast<int>(n)) {}
+
+    void freeze(int x) { val[x] = nsolid++; }
+
+    bool less(int x, int y) {
+        ++comparisons;
+        if (val[x] == gas && val[y] == gas) {
+            if (x == candidate) freeze(x);
+            else freeze(y);
+        }
+        if (val[x] == gas) candidate = x;
+        else if (val[y] == gas) candidate = y;
+        return val[x] < val[y];
+    }
+};
+
+template <typename Sorter>
+long long adversaryComparisons(std::size_t n, Sorter sorter) {
+    Adversary adv(n);
+    std::vector<int> v(n);
+    for (std::size_t i = 0; i < n; ++i) v[i] = static_cast<int>(i);
+    sorter(v, [&adv](int a, int b) { return adv.less(a, b); });
+    return adv.comparisons;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(12345);
+    const Shape shapes[] = {Shape::Random, Shape::Sorted, Shape::Reversed, Shape::FewValues, Shape::OrganPipe};
+
+    for (Shape shape : shapes) {
+        std::vector<Ranked> keys = makeKeys(200000, shape, rng);
+        benchCase("ranking", shape, keys, 5, rankedLess);
+
+        std::vector<MovieResult> results = makeResults(makeKeys(20000, shape, rng), rng);
+        benchCase("resultado", shape, results, 5, resultLess);
+
+        std::vector<int> ids;
+        ids.reserve(keys.size());
+        for (const Ranked& k : keys) ids.push_back(k.ratingCount * 16 + k.movieId % 16);
+        benchCase("ids", shape, ids, 5, [](int a, int b) { return a < b; });
+    }
+
+    std::printf("\nadversario de McIlroy (comparacoes):\n");
+    for (std::size_t n : {1000u, 10000u, 30000u}) {
+        long long legacy = adversaryComparisons(n, [](std::vector<int>& v, auto cmp) { legacyQuickSort(v, cmp); });
+        long long intro  = adversaryComparisons(n, [](std::vector<int>& v, auto cmp) { sort_utils::quickSort(v, cmp); });
+        long long stdS   = adversaryComparisons(n, [](std::vector<int>& v, auto cmp) { std::sort(v.begin(), v.end(), cmp); });
+        std::printf("n=%6zu  antigo %12lld  introsort %10lld  std::sort %10lld\n", n, legacy, intro, stdS);
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Alocador monotônico: a memória vem de blocos grandes e cada alocação só avança um
+// ponteiro. Nada é liberado sozinho; os blocos saem todos juntos no destrutor (ou em
+// release), então desmontar uma estrutura alocada aqui custa um free por bloco.
+// Os endereços nunca mudam, diferente de um vector ou do StringArena: dá para guardar
+// ponteiros e string_view para dentro da arena.
+// Os blocos dobram de tamanho a partir de firstBlock, até 1 MiB; pedidos maiores que o
+// bloco atual ganham um bloco próprio. Só para tipos triviais (nenhum destrutor é chamado).
+class MonotonicArena {
+public:
+    explicit MonotonicArena(std::size_t firstBlock = 4096);
+
+    MonotonicArena(MonotonicArena&&) noexcept = default;
+    MonotonicArena& operator=(MonotonicArena&&) noexcept = default;
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t align);
+
+    template <typename T>
+    T* allocateArray(std::size_t n) {
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    // Cópia do texto dentro da arena
+    std::string_view copy(std::string_view s);
+
+    // Libera todos os blocos; o que foi alocado antes deixa de valer
+    void release();
+
+    std::size_t blockCount() const { return blocks.size(); }
+    std::size_t bytesUsed() const { return used; }
+    std::size_t memoryUsage() const;
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::vector<std::size_t> blockSizes;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    std::size_t nextBlock;
+    std::size_t used = 0;
+
+    void grow(std::size_t atLeast);
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "movie_ratings.hpp"
+#include "users.hpp"
+
+// Avaliações repetidas de um usuário em um filme: as count avaliações a partir de position
+// (no trecho do filme em MovieRatings) contam como uma só, com a média dos desvios
+struct RepeatedRun {
+    std::uint32_t position;
+    std::uint32_t count;
+    float dev;
+};
+
+// Vetor esparso de um filme: usuários que o avaliaram e o desvio de cada nota (nota - média
+// do usuário), calculado na hora a partir do trecho do filme em MovieRatings.
+struct CenteredSpan {
+    const std::int32_t* users = nullptr; // índices densos do UserStore, em ordem crescente
+    const std::uint8_t* codes = nullptr; // nota em meias estrelas (nota * 2)
+    const float* exact = nullptr;        // notas originais, só quando o UserStore as guarda em float
+    const float* means = nullptr;        // média de cada usuário, pelo índice denso
+    std::size_t size = 0;                // avaliações, contando as repetidas
+
+    const RepeatedRun* runs = nullptr;   // repetições do filme, em ordem de posição
+    std::size_t runCount = 0;
+
+    // Desvio da avaliação i (fora das repetições)
+    float dev(std::size_t i) const {
+        float rating = exact ? exact[i] : static_cast<float>(codes[i]) * 0.5f;
+        return rating - means[users[i]];
+    }
+
+    // fn(usuário, desvio) para cada avaliador, uma vez só e em ordem crescente de usuário
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        std::size_t i = 0;
+        for (std::size_t k = 0; k < runCount; ++k) {
+            for (; i < runs[k].position; ++i) fn(users[i], dev(i));
+            fn(users[i], runs[k].dev);
+            i += runs[k].count;
+        }
+        for (; i < size; ++i) fn(users[i], dev(i));
+    }
+};
+
+// Avaliações centradas na média de cada usuário, por filme, e a norma de cada filme.
+// É a base das similaridades item-item (cosseno ajustado) de ItemNeighbors e da consulta similar.
+//
+// Montado em buildIndexes a partir de MovieRatings. Não guarda uma cópia das avaliações: só a
+// média de cada usuário, a norma de cada filme e as repetições (avaliações repetidas de um
+// mesmo filme por um usuário viram uma só, com a média dos desvios). raters() devolve o
+// trecho do filme em MovieRatings e os desvios saem na hora.
+class CenteredRatings {
+public:
+    void build(const UserStore& users, const MovieRatings& byMovie);
+
+    // byMovie é o mesmo MovieRatings passado para build
+    CenteredSpan raters(const MovieRatings& byMovie, int movie) const;
+
+    // Norma euclidiana dos desvios do filme
+    float norm(int movie) const { return norms[movie]; }
+
+    std::size_t movieCount() const { return norms.size(); }
+    std::size_t userCount() const { return means.size(); }
+    // Avaliadores somando todos os filmes, contando uma vez cada usuário repetido em um filme
+    std::size_t entryCount() const { return entries; }
+    std::size_t memoryUsage() const;
+
+private:
+    std::vector<float> means;
+    std::vector<float> norms;
+    std::size_t entries = 0;
+
+    // Repetições do filme m: runs[runOffsets[m], runOffsets[m + 1]). Vazio se não houver nenhuma.
+    std::vector<std::uint32_t> runOffsets;
+    std::vector<RepeatedRun> runs;
+};
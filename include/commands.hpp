@@ -0,0 +1,24 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include "context.hpp"
+#include "result_sink.hpp"
+
+// Interpretação de uma linha de comando (prefix, contains, fuzzy, user, movie, recommend,
+// similar, top, tags, stats) e despacho para a consulta correspondente, medindo cada consulta (metrics).
+// Usado pelo modo interativo, pelo --batch e pelo servidor.
+namespace commands {
+    struct Options {
+        GenreMatch genreMatch = GenreMatch::Substring;
+        OutputFormat format = OutputFormat::Table;
+        // Threads de uma consulta similar; no --batch é 1, o paralelismo fica entre as consultas
+        unsigned similarThreads = 1;
+    };
+
+    // Executa a linha: o resultado vai para out, no formato de options.format, e as mensagens
+    // de erro ("Unknown command", argumentos inválidos) para err. Linhas vazias ou incompletas
+    // não escrevem nada.
+    void execute(const DataContext& ctx, const std::string& line, const Options& options,
+                 std::ostream& out, std::ostream& err);
+}
@@ -2,22 +2,58 @@
 
 #include "movie.hpp"
 #include "users.hpp"
+#include "movie_ratings.hpp"
+#include "centered_ratings.hpp"
 #include "tags.hpp"
 #include "trie.hpp"
+#include "trigram_index.hpp"
+#include "genre_index.hpp"
+#include "item_neighbors.hpp"
 
 struct DataContext {
-    MovieHashTable movies;
-    UserHashTable users;
+    MovieStore movies;
+    UserStore users;
+
+    // Avaliações agrupadas por filme (transposta de users), montadas por buildIndexes
+    MovieRatings movieRatings;
+
+    // Avaliações por filme centradas na média de cada usuário (similaridades), montadas por buildIndexes
+    CenteredRatings centered;
     TagHashTable tags;
     TitleTrie trie;
 
+    // Trigramas dos títulos para a consulta contains, montados por buildIndexes
+    TrigramIndex titleIndex;
+
+    // movieIds com avaliações, na ordem (média desc, nº de avaliações desc, movieId asc).
+    // Montado por data_loader::buildIndexes depois do carregamento.
+    std::vector<int> rankedMovies;
+
+    // Todos os movieIds em ordem crescente; a posição de cada um é o índice denso
+    // usado pelos bitmaps de tags (diferente do índice do MovieStore, que segue a ordem de inserção)
+    std::vector<int> denseMovieIds;
+
+    // Listas por gênero para a consulta top
+    GenreIndex genreIndex;
+
+    // Vizinhos item-item da consulta recommend, montados por data_loader::buildNeighbors
+    ItemNeighbors neighbors;
+
+    // As tabelas crescem conforme a carga; os tamanhos aqui são só estimativas iniciais
     DataContext(
-        std::size_t movieCap = 30000,
-        std::size_t userCap  = 300000,
-        std::size_t tagCap   = 500000
+        std::size_t expectedMovies = 0,
+        std::size_t expectedUsers  = 0,
+        std::size_t expectedTags   = 0
     )
-        : movies(movieCap),
-          users(userCap),
-          tags(tagCap),
-          trie() {}
+        : movies(expectedMovies),
+          users(expectedUsers),
+          movieRatings(),
+          centered(),
+          tags(expectedTags),
+          trie(),
+          titleIndex(),
+          rankedMovies(),
+          denseMovieIds(),
+          genreIndex(),
+          neighbors() {}
 };
@@ -3,7 +3,24 @@
 #include "context.hpp"
 
 namespace data_loader {
+    // Tempos (em ms) de cada fase do carregamento paralelo de ratings
+    struct RatingsLoadStats {
+        std::size_t rows = 0;
+        double splitMs = 0.0;
+        double parseMs = 0.0;
+        double mergeMs = 0.0;
+    };
+
     void loadMovies(const std::string& path, DataContext& ctx);
     void loadRatings(const std::string& path, DataContext& ctx);
+    RatingsLoadStats loadRatingsParallel(const std::string& path, DataContext& ctx, unsigned threads);
     void loadTags(const std::string& path, DataContext& ctx);
+
+    // Índices derivados, montados uma vez depois que filmes, ratings e tags foram carregados
+    void buildIndexes(DataContext& ctx);
+
+    // Tabela de vizinhos item-item (recommend) com k vizinhos por filme, depois de buildIndexes.
+    // É a etapa mais cara da montagem, então fica separada e usa threads threads.
+    // Retorna o tempo em ms.
+    double buildNeighbors(DataContext& ctx, std::size_t k, unsigned threads);
 }
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "movie.hpp"
+
+// Como o gênero da consulta "top" é comparado com os gêneros do filme
+enum class GenreMatch {
+    Substring, // o texto aparece em qualquer lugar do campo de gêneros (comportamento original)
+    Exact      // o texto é exatamente um dos gêneros do filme
+};
+
+// Índice de gêneros para a consulta "top N <gênero>", montado uma vez depois do
+// carregamento. Usa a máscara de gêneros de cada filme (ver MovieStore), e para cada
+// gênero há uma lista dos filmes elegíveis já na ordem do ranking, então a
+// consulta é só uma fatia dessa lista.
+class GenreIndex {
+public:
+    // ranked: movieIds na ordem do ranking; só entram filmes com pelo menos minRatings avaliações
+    void build(const std::vector<int>& ranked, const MovieStore& movies, int minRatings);
+
+    // Até n filmes do gênero (índices densos do MovieStore), na ordem do ranking
+    std::vector<int> top(const MovieStore& movies, const std::string& genre,
+                         GenreMatch match, std::size_t n) const;
+
+    std::size_t genreCount() const;
+
+private:
+    std::vector<int> eligible;             // índices densos dos filmes elegíveis, na ordem do ranking
+    std::vector<std::vector<int>> byGenre; // por bit de gênero, posições em eligible na ordem do ranking
+    bool anyIrregular = false;
+};
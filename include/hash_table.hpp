@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Tabela hash de endereçamento aberto usada por filmes, usuários e tags.
+//
+// - Capacidade sempre potência de 2; a tabela dobra quando passa de 80% de ocupação,
+//   então o tamanho inicial é só uma estimativa.
+// - Robin Hood hashing: na inserção, quem está mais longe do seu balde ideal fica com o
+//   lugar, o que mantém os deslocamentos curtos e parecidos entre si.
+// - Um byte de metadado por slot (0 = vazio, senão deslocamento + 1). A busca para assim que
+//   encontra um slot com deslocamento menor que o da chave procurada, sem varrer o cluster.
+// - Metadados, chaves e valores ficam em arrays separados: a sondagem só toca os dois primeiros.
+//
+// As referências devolvidas por insertOrGet/find valem até a próxima inserção (a tabela pode
+// crescer ou deslocar entradas).
+
+namespace hash_table {
+
+// Finalizador do MurmurHash3: espalha ids sequenciais por todos os bits antes da máscara
+struct IntHash {
+    std::size_t operator()(int key) const {
+        std::uint32_t h = static_cast<std::uint32_t>(key);
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h;
+    }
+};
+
+// FNV-1a de 64 bits, com os bits altos dobrados sobre os baixos (a máscara só usa os baixos)
+inline std::uint64_t hashBytes(const char* data, std::size_t size) {
+    std::uint64_t h = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 1099511628211ull;
+    }
+    return h ^ (h >> 32);
+}
+
+// Serve para chaves std::string e std::string_view
+struct StringHash {
+    std::size_t operator()(std::string_view key) const {
+        return static_cast<std::size_t>(hashBytes(key.data(), key.size()));
+    }
+};
+
+// Para chaves que já são hashes de 64 bits
+struct U64Hash {
+    std::size_t operator()(std::uint64_t key) const {
+        return static_cast<std::size_t>(key ^ (key >> 29));
+    }
+};
+
+template <typename K, typename V, typename Hash>
+class OpenHashTable {
+public:
+    // expected: número de chaves esperado, só para evitar rehash durante a carga
+    explicit OpenHashTable(std::size_t expected = 0) : count(0) {
+        allocate(capacityFor(expected));
+    }
+
+    // Valor da chave; se ela não existir, cria um V{} e marca inserted = true
+    V& insertOrGet(const K& key, bool& inserted) {
+        inserted = false;
+        std::size_t slot = lookup(key);
+        if (slot != kNotFound) return values[slot];
+
+        if ((count + 1) * 5 > dist.size() * 4) {
+            rehash(dist.size() * 2);
+        }
+
+        K k = key;
+        V v{};
+        slot = place(k, v);
+        while (slot == kNotFound) {
+            // Deslocamento passou de 254: acontece só com hash muito ruim; cresce e tenta de novo
+            rehash(dist.size() * 2);
+            slot = place(k, v);
+        }
+        ++count;
+        inserted = true;
+        return values[slot];
+    }
+
+    V* find(const K& key) {
+        std::size_t slot = lookup(key);
+        return slot == kNotFound ? nullptr : &values[slot];
+    }
+
+    const V* find(const K& key) const {
+        std::size_t slot = lookup(key);
+        return slot == kNotFound ? nullptr : &values[slot];
+    }
+
+    // Garante espaço para n chaves sem rehash
+    void reserve(std::size_t n) {
+        std::size_t cap = capacityFor(n);
+        if (cap > dist.size()) rehash(cap);
+    }
+
+    std::size_t size() const { return count; }
+    std::size_t capacity() const { return dist.size(); }
+
+    // fn(chave, valor) para cada entrada, na ordem dos slots
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        for (std::size_t i = 0; i < dist.size(); ++i) {
+            if (dist[i] != 0) fn(keys[i], values[i]);
+        }
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (std::size_t i = 0; i < dist.size(); ++i) {
+            if (dist[i] != 0) fn(keys[i], values[i]);
+        }
+    }
+
+    // Maior deslocamento (em slots) de uma chave em relação ao seu balde ideal
+    std::size_t maxProbeLength() const {
+        std::size_t longest = 0;
+        for (std::uint8_t d : dist) {
+            if (d > longest) longest = d;
+        }
+        return longest == 0 ? 0 : longest - 1;
+    }
+
+    double averageProbeLength() const {
+        if (count == 0) return 0.0;
+        std::size_t total = 0;
+        for (std::uint8_t d : dist) {
+            if (d != 0) total += d - 1;
+        }
+        return static_cast<double>(total) / static_cast<double>(count);
+    }
+
+private:
+    static constexpr std::size_t kNotFound = static_cast<std::size_t>(-1);
+    static constexpr std::size_t kMinCapacity = 16;
+    static constexpr std::uint8_t kMaxDist = 255;
+
+    std::vector<std::uint8_t> dist;
+    std::vector<K> keys;
+    std::vector<V> values;
+    std::size_t mask = 0;
+    std::size_t count;
+
+    static std::size_t capacityFor(std::size_t n) {
+        std::size_t cap = kMinCapacity;
+        while (cap * 4 < n * 5) cap *= 2;
+        return cap;
+    }
+
+    void allocate(std::size_t cap) {
+        dist.assign(cap, 0);
+        keys.assign(cap, K{});
+        values.assign(cap, V{});
+        mask = cap - 1;
+    }
+
+    std::size_t lookup(const K& key) const {
+        std::size_t idx = Hash{}(key) & mask;
+        for (std::uint8_t d = 1;; ++d) {
+            // Slot vazio ou com alguém mais perto de casa que nós: a chave não está na tabela
+            if (dist[idx] < d) return kNotFound;
+            if (dist[idx] == d && keys[idx] == key) return idx;
+            idx = (idx + 1) & mask;
+        }
+    }
+
+    // Coloca (key, value), que não estão na tabela. Devolve o slot onde a chave nova ficou,
+    // ou kNotFound se algum deslocamento estourasse o byte (nada é alterado nesse caso).
+    std::size_t place(K& key, V& value) {
+        // Primeira passada só confere se a cadeia de deslocamentos cabe no byte
+        {
+            std::size_t idx = Hash{}(key) & mask;
+            unsigned d = 1;
+            for (;;) {
+                if (d >= kMaxDist) return kNotFound;
+                if (dist[idx] == 0) break;
+                if (dist[idx] < d) d = dist[idx];
+                idx = (idx + 1) & mask;
+                ++d;
+            }
+        }
+
+        std::size_t idx = Hash{}(key) & mask;
+        std::uint8_t d = 1;
+        std::size_t result = kNotFound;
+        for (;;) {
+            if (dist[idx] == 0) {
+                dist[idx] = d;
+                keys[idx] = std::move(key);
+                values[idx] = std::move(value);
+                return result == kNotFound ? idx : result;
+            }
+            if (dist[idx] < d) {
+                // Robin Hood: o residente está mais perto de casa, cede o lugar e segue adiante
+                std::swap(d, dist[idx]);
+                std::swap(key, keys[idx]);
+                std::swap(value, values[idx]);
+                if (result == kNotFound) result = idx;
+            }
+            idx = (idx + 1) & mask;
+            ++d;
+        }
+    }
+
+    void rehash(std::size_t newCap) {
+        OpenHashTable next;
+        next.allocate(newCap);
+        for (std::size_t i = 0; i < dist.size(); ++i) {
+            if (dist[i] == 0) continue;
+            // place não mexe em nada quando falha, então dá para crescer e repetir
+            while (next.place(keys[i], values[i]) == kNotFound) {
+                next.rehash(next.dist.size() * 2);
+            }
+            ++next.count;
+        }
+        *this = std::move(next);
+    }
+};
+
+} // namespace hash_table
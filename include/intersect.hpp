@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Interseção de listas ordenadas e sem duplicatas (listas de movieIds das tags).
+namespace intersect {
+    // Busca galopante: para cada elemento da lista menor, avança na maior com
+    // passos exponenciais e busca binária. Boa quando os tamanhos são muito diferentes.
+    void galloping(const int* small, std::size_t smallSize,
+                   const int* large, std::size_t largeSize,
+                   std::vector<int>& out);
+
+    // Merge linear das duas listas, comparando blocos de 4 elementos com SSE2
+    // quando disponível. Boa quando os tamanhos são parecidos.
+    void merge(const int* a, std::size_t aSize,
+               const int* b, std::size_t bSize,
+               std::vector<int>& out);
+
+    // Escolhe entre galloping e merge conforme a razão entre os tamanhos
+    void intersectPair(const std::vector<int>& a, const std::vector<int>& b, std::vector<int>& out);
+    // O mesmo para listas dadas por ponteiro e tamanho (trechos de um CSR)
+    void intersectPair(const int* a, std::size_t aSize, const int* b, std::size_t bSize, std::vector<int>& out);
+
+    // Interseção de todas as listas, começando pela menor
+    void intersectAll(std::vector<const std::vector<int>*> lists, std::vector<int>& out);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "centered_ratings.hpp"
+#include "movie.hpp"
+
+// Vizinhos de um filme: trecho contíguo da tabela de ItemNeighbors
+struct NeighborSpan {
+    const std::int32_t* movies = nullptr; // índices densos do MovieStore
+    const float* sims = nullptr;          // similaridade, em ordem decrescente
+    std::size_t size = 0;
+};
+
+// Tabela de vizinhos item-item para a consulta recommend.
+//
+// A similaridade entre dois filmes é o cosseno ajustado (ver CenteredRatings): sim(i, j) =
+// soma dos produtos dos desvios dos usuários que avaliaram os dois / (norma de i * norma de j).
+// As normas usam todas as avaliações de cada filme, o que já puxa para baixo pares com poucas
+// avaliações em comum. Só ficam os k vizinhos de maior similaridade positiva de cada filme, com pelo
+// menos minCommon usuários em comum, em formato CSR.
+//
+// A montagem percorre, para cada filme i, os históricos dos seus avaliadores (transposta do
+// CSR de MovieRatings com os desvios de CenteredRatings, ordenada por filme) acumulando só os pares (i, j) com j > i; cada par entra nos
+// vizinhos dos dois filmes. Os filmes são divididos em blocos entre as threads de um ThreadPool.
+// Cada par é calculado uma única vez e o desempate é total, então o resultado não depende do
+// número de threads. O custo é a soma dos quadrados dos tamanhos dos históricos, por isso a
+// tabela só é montada quando pedida (--neighbors) e é guardada no snapshot.
+class ItemNeighbors {
+public:
+    void build(const MovieStore& movies, const MovieRatings& byMovie, const CenteredRatings& centered,
+               std::size_t k, std::size_t minCommon, unsigned threads);
+
+    // Tabela já pronta (snapshot): offsets por filme sobre movies/sims
+    void assign(std::size_t k, std::vector<std::uint32_t> offsets,
+                std::vector<std::int32_t> movies, std::vector<float> sims);
+
+    // Vizinhos do filme; vazio se a tabela não foi montada
+    NeighborSpan neighbors(int movie) const;
+
+    // 0 enquanto a tabela não foi montada
+    std::size_t neighborsPerMovie() const { return k; }
+    std::size_t pairCount() const { return neighborMovies.size(); }
+    std::size_t memoryUsage() const;
+
+    // Arrays da tabela, para o snapshot
+    const std::vector<std::uint32_t>& offsetColumn() const { return offsets; }
+    const std::vector<std::int32_t>& movieColumn() const { return neighborMovies; }
+    const std::vector<float>& simColumn() const { return neighborSims; }
+
+private:
+    std::size_t k = 0;
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::int32_t> neighborMovies;
+    std::vector<float> neighborSims;
+};
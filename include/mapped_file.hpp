@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Mapeia um arquivo inteiro em memória (somente leitura) para que os loaders
+// possam fazer o parse direto no buffer, sem copiar linha por linha.
+// Se o mmap não estiver disponível, o arquivo é lido de uma vez para um buffer.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const;
+    const char* data() const;
+    std::size_t size() const;
+
+private:
+    const char* ptr;
+    std::size_t length;
+    bool opened;
+    bool mapped;
+    std::vector<char> fallback;
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "result_sink.hpp"
+
+// Medições do programa em execução, mostradas pelo comando stats.
+//
+// - Cada tipo de consulta tem um histograma de latência com baldes logarítmicos (8 por
+//   potência de 2, erro relativo de até 12,5%), contado com atômicos relaxed para o --batch e
+//   o servidor, e totais de linhas lidas dos índices, elementos ordenados e linhas emitidas.
+// - As consultas somam linhas lidas e ordenadas em contadores da thread (addScanned/addSorted);
+//   o QueryTimer zera esses contadores, mede o tempo com o relógio monotônico e junta tudo no
+//   histograma do tipo de consulta quando sai de escopo.
+// - Cada função do data_loader registra o seu tempo e as linhas processadas com um LoadTimer.
+//
+// Compilado com -DNO_METRICS, os temporizadores e contadores viram classes e funções vazias
+// (nenhuma leitura de relógio nem escrita) e stats só avisa que as medições estão desligadas.
+namespace metrics {
+    enum class Query {
+        Prefix,
+        PrefixTop,
+        Contains,
+        Fuzzy,
+        User,
+        Movie,
+        Recommend,
+        Similar,
+        Top,
+        Tags,
+        Count
+    };
+
+    enum class LoadPhase {
+        Movies,
+        Ratings,
+        Tags,
+        Indexes,
+        Neighbors,
+        Count
+    };
+
+    // Tabelas de carga e de consultas no sink
+    void report(ResultSink& sink);
+
+#if defined(NO_METRICS)
+
+    inline void addScanned(std::size_t) {}
+    inline void addSorted(std::size_t) {}
+
+    class QueryTimer {
+    public:
+        QueryTimer(Query, const ResultSink&) {}
+    };
+
+    class LoadTimer {
+    public:
+        explicit LoadTimer(LoadPhase) {}
+        void setRows(std::size_t) {}
+    };
+
+#else
+
+    namespace detail {
+        // Contadores da consulta em andamento na thread (sem inicializador: TLS sem construtor)
+        struct Counters {
+            std::size_t scanned;
+            std::size_t sorted;
+        };
+        extern thread_local Counters current;
+
+        void recordQuery(Query query, std::uint64_t nanos, std::size_t emitted);
+        void recordLoad(LoadPhase phase, std::uint64_t nanos, std::size_t rows);
+
+        inline std::uint64_t nanosSince(std::chrono::steady_clock::time_point start) {
+            return static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+    }
+
+    // Entradas lidas dos índices (trie, listas de tags, avaliações, vizinhos)
+    inline void addScanned(std::size_t n) { detail::current.scanned += n; }
+    // Elementos passados a quickSort/selectTop
+    inline void addSorted(std::size_t n) { detail::current.sorted += n; }
+
+    class QueryTimer {
+    public:
+        QueryTimer(Query query, const ResultSink& sink)
+            : query(query), sink(sink), start(std::chrono::steady_clock::now()) {
+            detail::current = detail::Counters{0, 0};
+        }
+        ~QueryTimer() { detail::recordQuery(query, detail::nanosSince(start), sink.rowCount()); }
+
+        QueryTimer(const QueryTimer&) = delete;
+        QueryTimer& operator=(const QueryTimer&) = delete;
+
+    private:
+        Query query;
+        const ResultSink& sink;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    class LoadTimer {
+    public:
+        explicit LoadTimer(LoadPhase phase) : phase(phase), start(std::chrono::steady_clock::now()) {}
+        ~LoadTimer() { detail::recordLoad(phase, detail::nanosSince(start), rows); }
+
+        void setRows(std::size_t n) { rows = n; }
+
+        LoadTimer(const LoadTimer&) = delete;
+        LoadTimer& operator=(const LoadTimer&) = delete;
+
+    private:
+        LoadPhase phase;
+        std::chrono::steady_clock::time_point start;
+        std::size_t rows = 0;
+    };
+
+#endif
+}
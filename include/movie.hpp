@@ -1,42 +1,94 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "hash_table.hpp"
+#include "string_arena.hpp"
+
 // NÃO usar std::map, std::unordered_map, std::set etc.
 
-struct Movie {
-    int movieId;
-    std::string title;
-    std::string genres;
-    int year;
+// Catálogo de filmes em colunas (structure of arrays).
+//
+// Cada filme ganha um índice denso (0, 1, 2, ... na ordem de inserção) e a tabela hash só
+// mapeia movieId -> índice. Os campos ficam em arrays separados, então varreduras sobre as
+// avaliações (ranking, top) percorrem só ratingCount/ratingSum contíguos, sem arrastar
+// os textos pelo cache. Títulos e gêneros ficam em um StringArena; os campos de gêneros,
+// que se repetem muito, são internados.
+//
+// Cada nome de gênero (o campo vem como "A|B|C,ano") recebe um bit de uma máscara de 64 bits.
+// Campos fora desse formato, ou com gêneros além dos 64 primeiros, são marcados como irregulares
+// e só podem ser consultados pelo texto.
+class MovieStore {
+public:
+    explicit MovieStore(std::size_t expected = 0);
 
-    int ratingCount = 0;
-    double ratingSum = 0.0;
-};
+    // Índice denso do filme, criando-o (sem título e sem avaliações) se ainda não existir
+    int insertOrGet(int movieId);
 
-struct MovieHashEntry {
-    bool occupied = false;
-    bool deleted  = false;
-    int key = -1;
-    Movie value;
-};
+    // Índice denso do filme, ou -1 se ele não existir
+    int indexOf(int movieId) const;
 
-class MovieHashTable {
-public:
-    explicit MovieHashTable(std::size_t capacity);
+    // Título, campo de gêneros e ano vindos do movies.csv
+    void setInfo(int index, std::string_view title, std::string_view genres, int year);
+
+    void addRating(int index, double rating) {
+        ratingSums[index] += rating;
+        ++ratingCounts[index];
+    }
+
+    // Soma count avaliações já acumuladas (junção do loader paralelo, snapshot)
+    void addRatings(int index, int count, double sum) {
+        ratingCounts[index] += count;
+        ratingSums[index] += sum;
+    }
 
-    Movie& insertOrGet(int movieId);
-    Movie* find(int movieId);
-    const Movie* find(int movieId) const;
+    void reserve(std::size_t n);
 
-    std::vector<MovieHashEntry>& rawTable();
-    const std::vector<MovieHashEntry>& rawTable() const;
+    std::size_t size() const { return ids.size(); }
+
+    int movieId(int index) const { return ids[index]; }
+    int year(int index) const { return years[index]; }
+    int ratingCount(int index) const { return ratingCounts[index]; }
+    double ratingSum(int index) const { return ratingSums[index]; }
+    double average(int index) const { return ratingSums[index] / static_cast<double>(ratingCounts[index]); }
+    std::uint64_t genreMask(int index) const { return genreMasks[index]; }
+    bool irregularGenres(int index) const { return irregular[index] != 0; }
+
+    // Os views valem até a próxima inserção de texto (setInfo)
+    std::string_view title(int index) const { return text.view(titles[index]); }
+    std::string_view genres(int index) const { return text.view(genreFields[index]); }
+
+    // Colunas inteiras, para varreduras
+    const std::vector<int>& movieIds() const { return ids; }
+    const std::vector<int>& ratingCountColumn() const { return ratingCounts; }
+    const std::vector<double>& ratingSumColumn() const { return ratingSums; }
+
+    // O índice de cada nome é o seu bit em genreMask
+    const std::vector<std::string>& genreNames() const { return names; }
+
+    std::size_t capacity() const;
+    std::size_t maxProbeLength() const;
+    std::size_t columnMemoryUsage() const;
+    std::size_t textMemoryUsage() const;
 
 private:
-    std::vector<MovieHashEntry> table;
-    std::size_t count;
+    hash_table::OpenHashTable<int, int, hash_table::IntHash> index; // movieId -> índice denso
+
+    std::vector<int> ids;
+    std::vector<int> years;
+    std::vector<int> ratingCounts;
+    std::vector<double> ratingSums;
+    std::vector<std::uint64_t> genreMasks;
+    std::vector<std::uint8_t> irregular;
+    std::vector<StringRef> titles;
+    std::vector<StringRef> genreFields;
+
+    std::vector<std::string> names;
+    StringArena text;
 
-    std::size_t hash(int key) const;
-    std::size_t probe(std::size_t h, std::size_t step) const;
+    int genreBit(std::string_view name);
 };
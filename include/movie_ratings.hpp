@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "users.hpp"
+
+// Avaliações de um filme: trecho contíguo do CSR de MovieRatings
+struct RaterSpan {
+    const std::int32_t* users = nullptr;  // índices densos do UserStore, em ordem crescente
+    const std::uint8_t* codes = nullptr;  // nota em meias estrelas (nota * 2)
+    const float* exact = nullptr;         // notas originais, só quando o UserStore as guarda em float
+    std::size_t size = 0;
+
+    float rating(std::size_t i) const {
+        return exact ? exact[i] : static_cast<float>(codes[i]) * 0.5f;
+    }
+};
+
+// Índice invertido das avaliações: para cada filme (índice denso do MovieStore), os
+// usuários que o avaliaram e as notas, em formato CSR.
+//
+// É a transposta do CSR do UserStore, montada por contagem em buildIndexes logo depois
+// de UserStore::finalize (O(avaliações), duas passadas). As notas usam a mesma
+// representação do UserStore: códigos de meia estrela ou float.
+class MovieRatings {
+public:
+    void build(const UserStore& users, std::size_t movieCount);
+
+    RaterSpan raters(int movie) const;
+
+    std::size_t movieCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    std::size_t memoryUsage() const;
+
+private:
+    std::vector<std::uint64_t> offsets;
+    std::vector<std::int32_t> users;
+    std::vector<std::uint8_t> codes;
+    std::vector<float> exact;
+};
@@ -3,10 +3,29 @@
 #include <string>
 #include <vector>
 #include "context.hpp"
+#include "result_sink.hpp"
 
+// As consultas só leem o DataContext e entregam o resultado ao sink (linhas tipadas; o
+// formato da saída fica no sink), então podem rodar ao mesmo tempo em threads diferentes
+// (modo --batch), cada uma com o seu sink.
+// Toda consulta descreve a sua tabela mesmo sem resultados, para o JSON sempre ter a seção.
 namespace queries {
-    void queryPrefix(DataContext& ctx, const std::string& prefix);
-    void queryUser(DataContext& ctx, int userId);
-    void queryTop(DataContext& ctx, int n, const std::string& genre);
-    void queryTags(DataContext& ctx, const std::vector<std::string>& tags);
+    // Termo da consulta tags. Um termo que começa entre aspas é sempre uma tag literal;
+    // fora das aspas, "|" e "-tag" são os operadores OR e NOT.
+    struct TagToken {
+        std::string text;
+        bool quoted = false;
+    };
+
+    void queryPrefix(const DataContext& ctx, ResultSink& sink, const std::string& prefix);
+    void queryPrefixTop(const DataContext& ctx, ResultSink& sink, const std::string& prefix, int n);
+    void queryContains(const DataContext& ctx, ResultSink& sink, const std::string& text);
+    void queryFuzzy(const DataContext& ctx, ResultSink& sink, const std::string& text, int maxEdits);
+    void queryUser(const DataContext& ctx, ResultSink& sink, int userId);
+    void queryMovie(const DataContext& ctx, ResultSink& sink, int movieId);
+    void queryRecommend(const DataContext& ctx, ResultSink& sink, int userId, int n);
+    void querySimilar(const DataContext& ctx, ResultSink& sink, int movieId, int n, unsigned threads = 1);
+    void queryTop(const DataContext& ctx, ResultSink& sink, int n, const std::string& genre,
+                  GenreMatch match = GenreMatch::Substring);
+    void queryTags(const DataContext& ctx, ResultSink& sink, const std::vector<TagToken>& tags);
 }
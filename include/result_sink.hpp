@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string_view>
+
+#include "table_writer.hpp"
+
+// Formato da saída das consultas (--output)
+enum class OutputFormat {
+    Table, // tabelas alinhadas (padrão)
+    Json,  // um objeto JSON por linha para cada comando
+    Tsv    // cabeçalho com as chaves e linhas separadas por tab; linha em branco no fim de cada tabela
+};
+
+enum class ColumnType {
+    Integer,
+    Real,
+    Text,
+    // Número guardado como texto (o ano do campo de gêneros): na tabela e no TSV sai como está;
+    // no JSON vira número se for só dígitos, null se estiver vazio e string nos outros casos
+    IntegerText
+};
+
+struct Column {
+    const char* header;         // cabeçalho (Grid) ou rótulo antes do valor (Labeled) na tabela
+    const char* key;            // nome do campo no JSON e no TSV
+    ColumnType type;
+    std::size_t width = 0;      // largura na tabela, alinhada à direita (0 = sem alinhamento)
+    int precision = 6;          // casas decimais na tabela (Real)
+    std::size_t maxChars = 0;   // corte do texto na tabela (0 = sem corte)
+    bool tableOnly = false;     // só aparece na tabela (barra do histograma)
+};
+
+enum class TableStyle {
+    Grid,   // cabeçalho, linha de traços e uma linha por registro; no JSON, lista de objetos
+    Labeled // cada registro em uma linha "rótulo valor | rótulo valor"; no JSON, um objeto
+};
+
+struct TableSpec {
+    const char* key;            // nome da seção no objeto JSON do comando
+    TableStyle style;
+    const Column* columns;
+    std::size_t columnCount;
+    std::size_t rule = 0;       // Grid: largura da linha de traços abaixo do cabeçalho
+    bool blankLineBefore = false; // Grid: linha em branco antes do cabeçalho (só na tabela)
+};
+
+// Destino dos resultados de uma consulta.
+//
+// As consultas descrevem cada tabela com um TableSpec e preenchem as linhas com valores
+// tipados, célula a célula na ordem das colunas; o formato (tabela, JSON ou TSV) fica todo
+// no sink. endResult fecha a resposta de um comando (no JSON, o objeto da linha) e escreve
+// o buffer; um comando que não produziu nada não gera resposta.
+// Uma tabela Grid sem linhas não imprime nada no formato tabela (nem o cabeçalho).
+class ResultSink {
+public:
+    virtual ~ResultSink() = default;
+
+    virtual void endResult() = 0;
+
+    virtual void beginTable(const TableSpec& spec) = 0;
+    virtual void endTable() = 0;
+
+    virtual void integer(long long value) = 0;
+    virtual void real(double value) = 0;
+    virtual void text(std::string_view value) = 0;
+    virtual void endRow() = 0;
+
+    // Resposta sem tabela ("User not found"); no JSON vira {"message": ...}
+    virtual void message(std::string_view text) = 0;
+
+    // Linhas de tabela escritas até agora (métricas do comando stats)
+    std::size_t rowCount() const { return rows; }
+
+protected:
+    std::size_t rows = 0;
+};
+
+// Mesma saída das versões anteriores, com TableWriter
+class TableSink : public ResultSink {
+public:
+    explicit TableSink(std::ostream& out);
+
+    void endResult() override;
+    void beginTable(const TableSpec& spec) override;
+    void endTable() override {}
+    void integer(long long value) override;
+    void real(double value) override;
+    void text(std::string_view value) override;
+    void endRow() override;
+    void message(std::string_view text) override;
+
+private:
+    TableWriter writer;
+    const TableSpec* spec = nullptr;
+    std::size_t column = 0;
+    bool headerWritten = false;
+
+    const Column& beginCell();
+};
+
+class TsvSink : public ResultSink {
+public:
+    explicit TsvSink(std::ostream& out);
+
+    void endResult() override;
+    void beginTable(const TableSpec& spec) override;
+    void endTable() override;
+    void integer(long long value) override;
+    void real(double value) override;
+    void text(std::string_view value) override;
+    void endRow() override;
+    void message(std::string_view text) override;
+
+private:
+    TableWriter writer;
+    const TableSpec* spec = nullptr;
+    std::size_t column = 0;
+    bool firstCell = true;
+
+    // Próxima célula; false se a coluna for só da tabela
+    bool beginCell();
+};
+
+// JSON em streaming: os valores vão direto para o buffer, sem montar árvore nenhuma
+class JsonSink : public ResultSink {
+public:
+    explicit JsonSink(std::ostream& out);
+
+    void endResult() override;
+    void beginTable(const TableSpec& spec) override;
+    void endTable() override;
+    void integer(long long value) override;
+    void real(double value) override;
+    void text(std::string_view value) override;
+    void endRow() override;
+    void message(std::string_view text) override;
+
+private:
+    TableWriter writer;
+    const TableSpec* spec = nullptr;
+    std::size_t column = 0;
+    bool inResult = false;
+    bool firstRow = true;
+    bool firstField = true;
+
+    void beginSection();
+    bool beginCell();
+    void string(std::string_view value);
+};
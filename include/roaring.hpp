@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Container de um bitmap roaring: guarda os 16 bits baixos dos valores que
+// compartilham os mesmos 16 bits altos. Até 4096 valores usa um array ordenado
+// de uint16; acima disso, um bitmap fixo de 65536 bits (1024 palavras).
+struct RoaringContainer {
+    std::vector<std::uint16_t> array;
+    std::vector<std::uint64_t> bits;
+    std::uint32_t cardinality = 0;
+
+    bool isBitmap() const { return !bits.empty(); }
+};
+
+// Bitmap compactado no estilo roaring, sobre índices densos (uint32).
+// As operações AND/OR/AND NOT trabalham container a container.
+class RoaringBitmap {
+public:
+    // values precisa estar em ordem crescente e sem repetições
+    static RoaringBitmap fromSorted(const std::vector<std::uint32_t>& values);
+    // Todos os valores de [0, n)
+    static RoaringBitmap range(std::uint32_t n);
+
+    RoaringBitmap andWith(const RoaringBitmap& other) const;
+    RoaringBitmap orWith(const RoaringBitmap& other) const;
+    RoaringBitmap andNot(const RoaringBitmap& other) const;
+
+    bool contains(std::uint32_t value) const;
+    bool empty() const;
+    std::size_t cardinality() const;
+    void toVector(std::vector<std::uint32_t>& out) const;
+    std::size_t memoryUsage() const;
+
+private:
+    std::vector<std::uint16_t> keys; // 16 bits altos de cada container, em ordem crescente
+    std::vector<RoaringContainer> containers;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+#include "commands.hpp"
+#include "context.hpp"
+
+// Servidor de consultas: o DataContext é montado uma vez e os comandos chegam por socket,
+// no mesmo protocolo do stdin (uma linha por comando).
+//
+// - Socket Unix em unixPath e/ou TCP em 127.0.0.1:tcpPort, atendidos por um laço epoll.
+// - Cada linha recebida vira uma tarefa no pool de threads; um cliente pode mandar vários
+//   comandos sem esperar as respostas (pipelining), e elas voltam na ordem dos pedidos.
+// - A resposta de cada comando é a saída que ele teria no stdout, seguida das mensagens de
+//   erro, e termina com uma linha só com ".".
+// - Cada conexão tem o seu buffer de saída; uma conexão com muitas respostas pendentes
+//   para de ser lida até o cliente consumir o que já foi enviado.
+namespace server {
+    struct Options {
+        std::string unixPath;  // vazio = sem socket Unix
+        int tcpPort = -1;      // -1 = sem TCP
+        unsigned threads = 1;  // threads que executam os comandos
+        commands::Options commands;
+    };
+
+    // Atende até receber SIGINT ou SIGTERM. Retorna false e preenche error se não conseguir
+    // abrir os sockets.
+    bool run(const DataContext& ctx, const Options& options, std::string& error);
+}
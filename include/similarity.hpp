@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "centered_ratings.hpp"
+#include "movie.hpp"
+
+// Similaridade item-item sob demanda (consulta similar).
+namespace similarity {
+    // Mínimo de usuários em comum para um par de filmes contar (vizinhos e consulta similar)
+    const std::size_t kMinCommonRaters = 3;
+
+    // Produto escalar dos desvios de um filme (vetor esparso por usuário, ver CenteredSpan) com
+    // um vetor denso indexado pelo usuário; common recebe a soma de presence nos mesmos índices
+    // (presence vale 1 onde o vetor denso tem valor e 0 fora). Os desvios do filme são
+    // calculados na hora, com as notas de MovieRatings e as médias dos usuários.
+    // Com AVX2 usa gathers de 8 elementos; sparseDotScalar é a versão sem SIMD.
+    float sparseDot(const float* dense, const float* presence, const CenteredSpan& raters, std::uint32_t& common);
+    float sparseDotScalar(const float* dense, const float* presence, const CenteredSpan& raters,
+                          std::uint32_t& common);
+
+    struct Match {
+        int movie;            // índice denso do MovieStore
+        float sim;
+        std::uint32_t common; // usuários que avaliaram os dois filmes
+    };
+
+    // Os n filmes mais parecidos com movie pelo cosseno ajustado, do mais para o menos parecido
+    // (no empate, menor movieId). O vetor do filme é espalhado em um array denso por usuário e
+    // cada candidato é um produto escalar sobre os seus avaliadores; os candidatos são divididos
+    // em blocos entre threads threads.
+    std::vector<Match> mostSimilar(const MovieRatings& byMovie, const CenteredRatings& centered,
+                                   const MovieStore& movies, int movie, std::size_t n, unsigned threads);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include "context.hpp"
+
+// Snapshot binário do DataContext já montado.
+//
+// O arquivo guarda tudo em arrays planos (offsets no lugar de ponteiros), com um
+// cabeçalho versionado, o checksum do conteúdo e o tamanho/mtime dos CSVs de origem.
+// Na carga o arquivo é mapeado em memória e as estruturas são remontadas a partir
+// dos arrays, sem nenhum parse de texto.
+namespace snapshot {
+    // CSVs usados para montar o snapshot; servem para detectar um snapshot desatualizado
+    struct Sources {
+        std::string movies;
+        std::string ratings;
+        std::string tags;
+    };
+
+    // Grava o snapshot em path. Retorna false e preenche error em caso de falha.
+    bool write(const std::string& path, const DataContext& ctx, const Sources& sources, std::string& error);
+
+    // Carrega o snapshot de path em um DataContext recém-criado.
+    // Retorna false (sem alterar ctx) se o arquivo não existir, estiver corrompido,
+    // for de outra versão ou se algum CSV de origem tiver mudado.
+    bool load(const std::string& path, DataContext& ctx, const Sources& sources, std::string& error);
+}
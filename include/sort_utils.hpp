@@ -1,38 +1,144 @@
 #pragma once
 
+#include <cstddef>
+#include <utility>
 #include <vector>
 
 namespace sort_utils {
 
-//o template Comparator é a função que define o critério de desempate
+namespace detail {
+
+// Abaixo deste tamanho o trecho é ordenado por inserção
+constexpr std::size_t kInsertionCutoff = 16;
+// A partir deste tamanho o pivô é a mediana de três medianas (ninther)
+constexpr std::size_t kNintherThreshold = 128;
+
+// Desce heap[node] no heap heap[0..size) até que nenhum filho venha depois dele na ordem de cmp
+// (ou seja, a raiz é o elemento que viria por último)
 template <typename T, typename Comparator>
-void quickSort(std::vector<T>& arr, int left, int right, Comparator cmp) {
-    int i = left;
-    int j = right;
-    T pivot = arr[(left + right) / 2]; //escolhe o pivô como o elemento do meio
-
-    // Particionamento
-    while (i <= j) {
-        //enquanto o critério de comparação indicar que arr[i] < pivot, avança i
-        while (cmp(arr[i], pivot)) i++;
-        while (cmp(pivot, arr[j])) j--;
-
-        if (i <= j) {
-            // Troca os elementos em i e j
-            std::swap(arr[i], arr[j]);
-            i++;
-            j--;
-        }
+void siftDown(T* heap, std::size_t node, std::size_t size, Comparator& cmp) {
+    for (;;) {
+        std::size_t child = 2 * node + 1;
+        if (child >= size) return;
+        if (child + 1 < size && cmp(heap[child], heap[child + 1])) ++child;
+        if (!cmp(heap[node], heap[child])) return;
+        std::swap(heap[node], heap[child]);
+        node = child;
     }
+}
 
+// Heapsort de arr[lo, hi): usado quando o quicksort passa do limite de profundidade
+template <typename T, typename Comparator>
+void heapSort(std::vector<T>& arr, std::size_t lo, std::size_t hi, Comparator& cmp) {
+    T* heap = arr.data() + lo;
+    std::size_t n = hi - lo;
+    for (std::size_t i = n / 2; i-- > 0;) {
+        siftDown(heap, i, n, cmp);
+    }
+    for (std::size_t end = n; end-- > 1;) {
+        std::swap(heap[0], heap[end]);
+        siftDown(heap, 0, end, cmp);
+    }
+}
+
+// Ordenação por inserção de arr[lo, hi), movendo os elementos em vez de trocá-los
+template <typename T, typename Comparator>
+void insertionSort(std::vector<T>& arr, std::size_t lo, std::size_t hi, Comparator& cmp) {
+    for (std::size_t i = lo + 1; i < hi; ++i) {
+        if (!cmp(arr[i], arr[i - 1])) continue;
 
-    // Chamada recursiva para as duas metades
-    if (left < j) {
-        quickSort(arr, left, j, cmp);
+        T tmp = std::move(arr[i]);
+        std::size_t j = i;
+        do {
+            arr[j] = std::move(arr[j - 1]);
+            --j;
+        } while (j > lo && cmp(tmp, arr[j - 1]));
+        arr[j] = std::move(tmp);
     }
-    if (i < right) {
-        quickSort(arr, i, right, cmp);
+}
+
+// Deixa arr[a] <= arr[b] <= arr[c] na ordem de cmp
+template <typename T, typename Comparator>
+void sort3(std::vector<T>& arr, std::size_t a, std::size_t b, std::size_t c, Comparator& cmp) {
+    if (cmp(arr[b], arr[a])) std::swap(arr[a], arr[b]);
+    if (cmp(arr[c], arr[b])) std::swap(arr[b], arr[c]);
+    if (cmp(arr[b], arr[a])) std::swap(arr[a], arr[b]);
+}
+
+// Particiona arr[lo, hi) e devolve a posição final do pivô.
+// O pivô (mediana de três ou ninther) fica em arr[lo] durante a varredura e é comparado
+// por referência, sem cópia. Os elementos iguais ao pivô param as duas varreduras, então
+// vetores com muitas repetições continuam sendo divididos ao meio.
+template <typename T, typename Comparator>
+std::size_t partition(std::vector<T>& arr, std::size_t lo, std::size_t hi, Comparator& cmp) {
+    std::size_t n = hi - lo;
+    std::size_t mid = lo + n / 2;
+
+    if (n >= kNintherThreshold) {
+        sort3(arr, lo, mid, hi - 1, cmp);
+        sort3(arr, lo + 1, mid - 1, hi - 2, cmp);
+        sort3(arr, lo + 2, mid + 1, hi - 3, cmp);
+        sort3(arr, mid - 1, mid, mid + 1, cmp);
+    } else {
+        sort3(arr, lo, mid, hi - 1, cmp);
+    }
+    // Depois do sort3 sempre sobra, à direita, um elemento >= pivô (arr[hi - 1] ou arr[mid + 1]),
+    // que serve de sentinela para a varredura de i; o próprio pivô em arr[lo] para a de j
+    std::swap(arr[lo], arr[mid]);
+
+    std::size_t i = lo;
+    std::size_t j = hi;
+    for (;;) {
+        do ++i; while (cmp(arr[i], arr[lo]));
+        do --j; while (cmp(arr[lo], arr[j]));
+        if (i >= j) break;
+        std::swap(arr[i], arr[j]);
+    }
+    std::swap(arr[lo], arr[j]);
+    return j;
+}
+
+template <typename T, typename Comparator>
+void introSort(std::vector<T>& arr, std::size_t lo, std::size_t hi, int depth, Comparator& cmp) {
+    while (hi - lo > kInsertionCutoff) {
+        if (depth-- == 0) {
+            // Muitas partições ruins seguidas: termina com heapsort, O(n log n) garantido
+            heapSort(arr, lo, hi, cmp);
+            return;
+        }
+
+        std::size_t p = partition(arr, lo, hi, cmp);
+
+        // Recursão só no lado menor; o maior continua no laço, então a pilha fica em O(log n)
+        if (p - lo < hi - (p + 1)) {
+            introSort(arr, lo, p, depth, cmp);
+            lo = p + 1;
+        } else {
+            introSort(arr, p + 1, hi, depth, cmp);
+            hi = p;
+        }
     }
+    insertionSort(arr, lo, hi, cmp);
+}
+
+} // namespace detail
+
+
+// Introsort: quicksort com pivô mediana de três (ninther em trechos grandes), inserção em
+// trechos pequenos e heapsort quando a profundidade passa de 2*log2(n).
+// O template Comparator é a função que define o critério de desempate e deve ser uma ordem
+// estrita (cmp(a, a) == false). Ordena arr[left..right], com os dois extremos inclusos.
+template <typename T, typename Comparator>
+void quickSort(std::vector<T>& arr, int left, int right, Comparator cmp) {
+    if (left >= right) return;
+
+    std::size_t lo = static_cast<std::size_t>(left);
+    std::size_t hi = static_cast<std::size_t>(right) + 1;
+
+    int depth = 0;
+    for (std::size_t n = hi - lo; n > 1; n >>= 1) depth += 2;
+
+    detail::introSort(arr, lo, hi, depth, cmp);
 }
 
 
@@ -43,4 +149,62 @@ void quickSort(std::vector<T>& arr, Comparator cmp) {
     quickSort(arr, 0, static_cast<int>(arr.size()) - 1, cmp);
 }
 
+
+// Seleção parcial: deixa em arr só os k primeiros elementos na ordem de cmp, já ordenados.
+// Mantém um heap com os k melhores vistos até agora (a raiz é o pior deles), então custa
+// O(n log k) em vez de ordenar o vetor inteiro.
+template <typename T, typename Comparator>
+void selectTop(std::vector<T>& arr, std::size_t k, Comparator cmp) {
+    if (k >= arr.size()) {
+        quickSort(arr, cmp);
+        return;
+    }
+    if (k == 0) {
+        arr.clear();
+        return;
+    }
+
+    for (std::size_t i = k / 2; i-- > 0;) {
+        detail::siftDown(arr.data(), i, k, cmp);
+    }
+
+    for (std::size_t i = k; i < arr.size(); ++i) {
+        // Só entra no heap quem vem antes do pior dos k atuais
+        if (cmp(arr[i], arr[0])) {
+            std::swap(arr[i], arr[0]);
+            detail::siftDown(arr.data(), 0, k, cmp);
+        }
+    }
+
+    arr.resize(k);
+
+    // Heapsort dos k: o pior vai para o fim a cada passo
+    for (std::size_t end = k - 1; end > 0; --end) {
+        std::swap(arr[0], arr[end]);
+        detail::siftDown(arr.data(), 0, end, cmp);
+    }
+}
+
+
+// Versão incremental de selectTop, para candidatos que chegam um de cada vez: mantém em
+// heap[0..size) os k melhores na ordem de cmp vistos até agora. Enquanto size < k os
+// elementos só são acrescentados; a partir daí heap[0] é o pior dos k.
+// O resultado não sai ordenado (passe-o por selectTop/quickSort).
+template <typename T, typename Comparator>
+void pushBounded(T* heap, std::size_t& size, std::size_t k, const T& value, Comparator cmp) {
+    if (size < k) {
+        heap[size++] = value;
+        if (size == k) {
+            for (std::size_t i = k / 2; i-- > 0;) {
+                detail::siftDown(heap, i, k, cmp);
+            }
+        }
+        return;
+    }
+    if (k == 0 || !cmp(value, heap[0])) return;
+
+    heap[0] = value;
+    detail::siftDown(heap, 0, k, cmp);
+}
+
 } // namespace sort_utils
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "hash_table.hpp"
+
+// Posição de um texto dentro de um StringArena
+struct StringRef {
+    std::uint32_t offset = 0;
+    std::uint32_t length = 0;
+};
+
+// Todos os textos em um único bloco contínuo, referenciados por (offset, tamanho).
+// intern guarda cada texto distinto uma vez só (bom para campos muito repetidos, como
+// os gêneros); append sempre acrescenta (títulos, que quase nunca se repetem).
+// Os string_view devolvidos por view valem até o próximo append/intern.
+class StringArena {
+public:
+    StringRef append(std::string_view s);
+    StringRef intern(std::string_view s);
+
+    std::string_view view(StringRef ref) const {
+        return std::string_view(text.data() + ref.offset, ref.length);
+    }
+
+    std::size_t textSize() const;
+    std::size_t memoryUsage() const;
+
+private:
+    std::string text;
+    // hash do texto -> onde ele já está guardado
+    hash_table::OpenHashTable<std::uint64_t, StringRef, hash_table::U64Hash> interned;
+};
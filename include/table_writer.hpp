@@ -0,0 +1,69 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Escritor de tabelas de texto com buffer próprio.
+//
+// As células são formatadas direto no buffer (inteiros e doubles com std::to_chars, sem
+// passar pelo estado de formatação do stream), alinhadas à direita como std::setw, e o
+// buffer só vai para o stream quando passa de flushBytes ou no destrutor.
+// A saída é a mesma de setw + std::fixed + setprecision sobre um std::ostream.
+class TableWriter {
+public:
+    explicit TableWriter(std::ostream& out, std::size_t flushBytes = 1 << 16);
+    ~TableWriter();
+
+    TableWriter(const TableWriter&) = delete;
+    TableWriter& operator=(const TableWriter&) = delete;
+
+    // Texto sem alinhamento
+    TableWriter& text(std::string_view s) {
+        buffer.append(s.data(), s.size());
+        return *this;
+    }
+
+    TableWriter& text(char c) {
+        buffer.push_back(c);
+        return *this;
+    }
+
+    // Texto alinhado à direita em width colunas (sem cortar se for maior)
+    TableWriter& right(std::string_view s, std::size_t width) {
+        if (s.size() < width) buffer.append(width - s.size(), ' ');
+        return text(s);
+    }
+
+    // Inteiro alinhado à direita em width colunas (com um double, a menor representação exata)
+    template <typename Int>
+    TableWriter& number(Int value, std::size_t width = 0) {
+        char digits[32];
+        std::to_chars_result r = std::to_chars(digits, digits + sizeof(digits), value);
+        return right(std::string_view(digits, static_cast<std::size_t>(r.ptr - digits)), width);
+    }
+
+    // Número com precision casas decimais (como std::fixed), alinhado à direita em width colunas
+    TableWriter& fixed(double value, int precision, std::size_t width = 0);
+
+    TableWriter& repeat(char c, std::size_t count) {
+        buffer.append(count, c);
+        return *this;
+    }
+
+    // Fim de linha; esvazia o buffer se ele passou do limite
+    TableWriter& endLine() {
+        buffer.push_back('\n');
+        if (buffer.size() >= flushBytes) flush();
+        return *this;
+    }
+
+    void flush();
+
+private:
+    std::ostream& out;
+    std::string buffer;
+    std::size_t flushBytes;
+};
@@ -1,26 +1,72 @@
 #pragma once
 
+#include <cstdint>
+#include <string_view>
 #include <vector>
-#include <string>
+#include "arena.hpp"
+#include "hash_table.hpp"
+#include "roaring.hpp"
 
-struct TagHashEntry {
-    bool occupied = false;
-    bool deleted = false;
-    std::string key;
+// Depois de buildBitmaps, uma tag com bitmap não guarda mais a lista inteira: movieIds fica só
+// com os ids que não estão no catálogo de filmes (fora dos índices densos), normalmente nenhum.
+struct TagEntry {
     std::vector<int> movieIds;
+    std::int32_t bitmap = -1; // índice em TagHashTable::bitmaps, ou -1 se a tag não tiver bitmap
 };
 
+// As chaves são string_view para o texto de cada tag, guardado uma vez só em uma
+// MonotonicArena da própria tabela: nenhuma alocação por tag, e os textos saem todos juntos.
 class TagHashTable {
 public:
-    explicit TagHashTable(std::size_t capacity);
+    explicit TagHashTable(std::size_t expected = 0);
 
-    void addMovie(const std::string& tag, int movieId);
-    std::vector<int> getMovies(const std::string& tag) const;
+    void addMovie(std::string_view tag, int movieId);
+    std::vector<int>& insertOrGet(std::string_view tag);
+    const TagEntry* find(std::string_view tag) const;
 
-private:
-    std::vector<TagHashEntry> table;
-    std::size_t count;
+    void finalize();
+
+    // Monta os bitmaps (sobre os índices densos de denseMovieIds, em ordem crescente)
+    // das tags com pelo menos minSize filmes, e troca a lista dessas tags pelo bitmap.
+    // Tags menores ficam só com a lista. Chamado uma vez, depois de finalize.
+    void buildBitmaps(const std::vector<int>& denseMovieIds, std::size_t minSize);
+
+    const RoaringBitmap& bitmapAt(std::int32_t index) const { return bitmaps[index]; }
+
+    // Todos os movieIds da tag, em ordem crescente, venham da lista ou do bitmap
+    void movieIdsOf(const TagEntry& entry, const std::vector<int>& denseMovieIds, std::vector<int>& out) const;
+    std::size_t movieCount(const TagEntry& entry) const;
+
+    // Bitmap dos índices densos de movieIds (ordenados); os ids fora de denseMovieIds
+    // ficam de fora e vão para missing, se pedido
+    static RoaringBitmap denseBitmap(const std::vector<int>& movieIds, const std::vector<int>& denseMovieIds,
+                                     std::vector<int>* missing = nullptr);
+
+    // Bitmap da tag (vazio se ela não existir). Tags sem bitmap pré-calculado
+    // são convertidas a partir da lista.
+    RoaringBitmap bitmapOf(std::string_view tag, const std::vector<int>& denseMovieIds) const;
 
-    std::size_t hash(const std::string& s) const;
-    std::size_t probe(std::size_t h, std::size_t step) const;
+    // Memória das listas de filmes, dos bitmaps e dos textos das tags, para o relatório de carga
+    std::size_t listMemoryUsage() const;
+    std::size_t bitmapMemoryUsage() const;
+    std::size_t textMemoryUsage() const;
+
+    // Garante espaço para n entradas sem rehash
+    void reserve(std::size_t n);
+
+    std::size_t size() const;
+    std::size_t capacity() const;
+    std::size_t maxProbeLength() const;
+
+    // fn(std::string_view tag, TagEntry&) para cada tag
+    template <typename Fn>
+    void forEach(Fn&& fn) { table.forEach(fn); }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const { table.forEach(fn); }
+
+private:
+    MonotonicArena text;
+    hash_table::OpenHashTable<std::string_view, TagEntry, hash_table::StringHash> table;
+    std::vector<RoaringBitmap> bitmaps;
 };
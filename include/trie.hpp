@@ -1,27 +1,73 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
+#include "hash_table.hpp"
 
+// Nó de uma TRIE compactada (radix): cada aresta guarda um rótulo com vários
+// caracteres. Os nós ficam todos em um único vetor e se referenciam por índice.
 struct TrieNode {
-    bool isTerminal = false;
-    std::vector<int> movieIds;
-    TrieNode* children[128]{};
+    std::uint32_t labelOffset = 0; // início do rótulo da aresta que chega neste nó
+    std::uint32_t labelLength = 0;
+    std::int32_t firstChild = -1;  // filhos em lista ligada, ordenados pelo primeiro caractere
+    std::int32_t nextSibling = -1;
+    std::int32_t firstId = -1;     // movieIds dos títulos que terminam aqui (lista em idNext)
+    std::int32_t lastId = -1;
+    std::int32_t topBegin = -1;    // melhores filmes da subárvore em topCache (-1 = sem cache)
+    std::int32_t topCount = 0;
+};
 
-    TrieNode();
+// Título achado pela busca aproximada e a distância de edição até o texto buscado
+struct FuzzyMatch {
+    int movieId;
+    int distance;
 };
 
 class TitleTrie {
 public:
     TitleTrie();
-    ~TitleTrie();
 
-    void insert(const std::string& title, int movieId);
+    void insert(std::string_view title, int movieId);
     std::vector<int> searchPrefix(const std::string& prefix) const;
 
+    // Pré-calcula, para cada nó cuja subárvore tem mais de k filmes ranqueados,
+    // os k melhores filmes da subárvore. ranked lista os movieIds na ordem de
+    // ranking (os filmes fora da lista são ignorados pelas consultas top).
+    void buildTopCache(const std::vector<int>& ranked, std::size_t k);
+
+    // Os n melhores filmes (na ordem de ranked) com o prefixo dado.
+    // Usa o cache do nó quando n <= k; senão coleta e ordena a subárvore.
+    std::vector<int> topByPrefix(const std::string& prefix, std::size_t n) const;
+
+    // Títulos que têm um prefixo a até maxEdits edições de text (distância de Levenshtein:
+    // inserir, remover ou trocar um caractere), sem diferenciar maiúsculas de minúsculas.
+    // distance é a menor distância entre text e um prefixo do título. Sem ordem definida.
+    std::vector<FuzzyMatch> searchFuzzy(std::string_view text, int maxEdits) const;
+
+    // Relatório de memória: total de nós, de títulos e bytes alocados pela TRIE
+    std::size_t nodeCount() const;
+    std::size_t titleCount() const;
+    std::size_t memoryUsage() const;
+
 private:
-    TrieNode* root;
+    std::vector<TrieNode> nodes; // nodes[0] é a raiz
+    std::string labels;          // todos os rótulos das arestas, concatenados
+    std::vector<int> ids;
+    std::vector<int> idNext;
+
+    std::vector<int> rankedIds; // cópia de ranked
+    // movieId -> posição em ranked. Tabela hash e não vetor indexado pelo movieId: um id
+    // grande ou esparso (2147483647) não pode custar um vetor do tamanho do id
+    hash_table::OpenHashTable<int, int, hash_table::IntHash> rankOf;
+    std::vector<int> topCache;  // listas de melhores filmes de cada nó, concatenadas
+    std::size_t topK = 0;
+    std::string asciiScratch; // título sem os caracteres fora de ASCII, reaproveitado em insert
 
-    void collect(TrieNode* node, std::vector<int>& out) const;
-    void freeNode(TrieNode* node);
+    int newNode(std::uint32_t labelOffset, std::uint32_t labelLength);
+    int findPrefixNode(const std::string& prefix) const;
+    int rank(int movieId) const;
+    void collect(int node, std::vector<int>& out) const;
 };
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "hash_table.hpp"
+#include "movie.hpp"
+
+// Índice invertido de trigramas dos títulos, para a consulta "contains <texto>".
+//
+// - Títulos e texto são comparados sem diferenciar maiúsculas de minúsculas (só ASCII; os
+//   demais bytes entram como estão, então trechos em UTF-8 também casam).
+// - Cada trigrama (3 bytes seguidos do título em minúsculas) tem a lista dos índices do
+//   MovieStore dos títulos que o contêm, em ordem crescente e sem repetição. As listas ficam
+//   todas em um único vetor (CSR) e uma tabela hash leva do trigrama à sua lista.
+// - A busca intersecta as listas dos trigramas do texto e confere cada candidato no título:
+//   ter todos os trigramas não garante que eles apareçam em sequência.
+// - Textos com menos de 3 caracteres não têm trigrama e são comparados com todos os títulos.
+//
+// Montado por data_loader::buildIndexes, depois dos CSVs ou do snapshot.
+class TrigramIndex {
+public:
+    void build(const MovieStore& movies);
+
+    // Índices do MovieStore dos títulos que contêm text, em ordem crescente.
+    // candidates recebe quantos títulos foram conferidos.
+    std::vector<int> search(const MovieStore& movies, std::string_view text, std::size_t& candidates) const;
+
+    std::size_t trigramCount() const;
+    std::size_t memoryUsage() const;
+
+private:
+    hash_table::OpenHashTable<int, int, hash_table::IntHash> lists; // trigrama -> número da lista
+    std::vector<std::uint32_t> offsets; // lista i = postings[offsets[i], offsets[i + 1])
+    std::vector<int> postings;
+};
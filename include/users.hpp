@@ -1,36 +1,89 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
-struct UserRating {
-    int movieId;
-    float rating;
-};
+#include "hash_table.hpp"
+#include "movie.hpp"
 
-struct User {
-    int userId;
-    std::vector<UserRating> ratings;
-};
+// Avaliações de um usuário: trecho contíguo do CSR de UserStore
+struct RatingSpan {
+    const std::int32_t* movies = nullptr;  // índices densos do MovieStore
+    const std::uint8_t* codes = nullptr;   // nota em meias estrelas (nota * 2)
+    const float* exact = nullptr;          // notas originais, só quando alguma não cabe em codes
+    std::size_t size = 0;
 
-struct UserHashEntry {
-    bool occupied = false;
-    bool deleted = false;
-    int key = -1;
-    User value;
+    float rating(std::size_t i) const {
+        return exact ? exact[i] : static_cast<float>(codes[i]) * 0.5f;
+    }
 };
 
-class UserHashTable {
+// Usuários e suas avaliações.
+//
+// Durante a carga as avaliações só são acrescentadas em arrays de preparação
+// (usuário, movieId, nota), na ordem do arquivo. finalize() as agrupa por usuário em
+// formato CSR: offsets indexados pelo índice denso do usuário sobre um array contínuo de
+// filmes (índices densos do MovieStore) e um de notas em meias estrelas (1 byte).
+// Se alguma nota não for múltiplo de 0.5 entre 0 e 127.5, as notas originais são mantidas
+// em float no lugar dos códigos.
+class UserStore {
 public:
-    explicit UserHashTable(std::size_t capacity);
+    explicit UserStore(std::size_t expected = 0);
+
+    // ---- carga ----
+
+    // Índice denso do usuário, criando-o se ainda não existir
+    int insertOrGet(int userId);
+
+    void addRating(int user, int movieId, float rating);
+
+    // Acrescenta as avaliações de outro UserStore ainda não finalizado (blocos do loader
+    // paralelo), criando os usuários que faltarem na ordem em que aparecem nele
+    void append(const UserStore& other);
+
+    // Monta o CSR e libera os arrays de preparação. Todo movieId avaliado precisa estar em movies.
+    void finalize(const MovieStore& movies);
 
-    User& insertOrGet(int userId);
-    User* find(int userId);
-    const User* find(int userId) const;
+    // Recebe um CSR já pronto (snapshot): userIds na ordem dos índices densos e exatamente
+    // um entre codes e exact preenchido. Retorna false se algum userId se repetir.
+    bool assign(std::vector<int> userIds, std::vector<std::uint64_t> userOffsets,
+                std::vector<std::int32_t> movieIndexes, std::vector<std::uint8_t> ratingCodes,
+                std::vector<float> exactRatings);
+
+    // ---- consulta (depois de finalize) ----
+
+    // Índice denso do usuário, ou -1 se ele não existir
+    int indexOf(int userId) const;
+
+    RatingSpan ratings(int user) const;
+
+    std::size_t size() const { return ids.size(); }
+    int userId(int user) const { return ids[user]; }
+    std::size_t ratingCount() const { return movies.size(); }
+
+    // Arrays do CSR, para o snapshot
+    const std::vector<std::uint64_t>& offsetColumn() const { return offsets; }
+    const std::vector<std::int32_t>& movieColumn() const { return movies; }
+    const std::vector<std::uint8_t>& codeColumn() const { return codes; }
+    const std::vector<float>& exactColumn() const { return exact; }
+
+    std::size_t capacity() const;
+    std::size_t maxProbeLength() const;
+    std::size_t memoryUsage() const;
 
 private:
-    std::vector<UserHashEntry> table;
-    std::size_t count;
+    hash_table::OpenHashTable<int, int, hash_table::IntHash> index; // userId -> índice denso
+    std::vector<int> ids;
+
+    // Preparação (só durante a carga)
+    std::vector<std::int32_t> stagedUsers;
+    std::vector<std::int32_t> stagedMovieIds;
+    std::vector<float> stagedRatings;
 
-    std::size_t hash(int key) const;
-    std::size_t probe(std::size_t h, std::size_t step) const;
+    // CSR
+    std::vector<std::uint64_t> offsets;
+    std::vector<std::int32_t> movies;
+    std::vector<std::uint8_t> codes;
+    std::vector<float> exact;
 };
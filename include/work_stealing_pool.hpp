@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool fixo de threads para laços de tarefas independentes, com roubo de trabalho.
+//
+// run(count, task) executa task(0) .. task(count - 1) e só retorna quando todas terminarem.
+// Cada thread (a que chamou run é uma delas) começa com um trecho contínuo dos índices;
+// quando o seu acaba, rouba a metade final do trecho de outra thread. Tarefas de custo
+// muito diferente (um prefix curto e um similar, por exemplo) não deixam threads paradas.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(std::size_t threads);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void run(std::size_t count, const std::function<void(std::size_t)>& task);
+
+    std::size_t size() const;
+
+private:
+    // Índices [begin, end) ainda não executados de uma thread; alinhado para que
+    // threads diferentes não disputem a mesma linha de cache
+    struct alignas(64) Range {
+        std::mutex mtx;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    std::size_t threadCount;
+    std::unique_ptr<Range[]> ranges;
+    std::vector<std::thread> workers;
+
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(std::size_t)>* current = nullptr;
+    std::size_t generation = 0;
+    std::size_t busy = 0;
+    bool stopping = false;
+
+    void workerLoop(std::size_t self);
+    void work(std::size_t self, const std::function<void(std::size_t)>& task);
+    bool takeOwn(std::size_t self, std::size_t& index);
+    bool steal(std::size_t self);
+};
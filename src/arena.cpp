@@ -0,0 +1,55 @@
+#include "arena.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+const std::size_t kMaxBlock = 1 << 20;
+
+} // namespace
+
+MonotonicArena::MonotonicArena(std::size_t firstBlock) : nextBlock(firstBlock == 0 ? 1 : firstBlock) {}
+
+void* MonotonicArena::allocate(std::size_t size, std::size_t align) {
+    std::uintptr_t p = reinterpret_cast<std::uintptr_t>(cursor);
+    std::uintptr_t aligned = (p + align - 1) & ~static_cast<std::uintptr_t>(align - 1);
+    if (cursor == nullptr || aligned + size > reinterpret_cast<std::uintptr_t>(limit)) {
+        grow(size + align - 1);
+        p = reinterpret_cast<std::uintptr_t>(cursor);
+        aligned = (p + align - 1) & ~static_cast<std::uintptr_t>(align - 1);
+    }
+    cursor = reinterpret_cast<char*>(aligned + size);
+    used += size;
+    return reinterpret_cast<void*>(aligned);
+}
+
+std::string_view MonotonicArena::copy(std::string_view s) {
+    if (s.empty()) return std::string_view();
+    char* dest = static_cast<char*>(allocate(s.size(), 1));
+    std::memcpy(dest, s.data(), s.size());
+    return std::string_view(dest, s.size());
+}
+
+void MonotonicArena::release() {
+    blocks.clear();
+    blockSizes.clear();
+    cursor = nullptr;
+    limit = nullptr;
+    used = 0;
+}
+
+std::size_t MonotonicArena::memoryUsage() const {
+    std::size_t total = 0;
+    for (std::size_t size : blockSizes) total += size;
+    return total;
+}
+
+void MonotonicArena::grow(std::size_t atLeast) {
+    std::size_t size = nextBlock > atLeast ? nextBlock : atLeast;
+    blocks.emplace_back(new char[size]);
+    blockSizes.push_back(size);
+    cursor = blocks.back().get();
+    limit = cursor + size;
+    if (nextBlock < kMaxBlock) nextBlock *= 2;
+}
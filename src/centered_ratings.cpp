@@ -0,0 +1,76 @@
+#include "centered_ratings.hpp"
+
+#include <cmath>
+
+void CenteredRatings::build(const UserStore& store, const MovieRatings& byMovie) {
+    std::size_t users = store.size();
+    std::size_t movieCount = byMovie.movieCount();
+
+    means.assign(users, 0.0f);
+    for (std::size_t u = 0; u < users; ++u) {
+        RatingSpan span = store.ratings(static_cast<int>(u));
+        if (span.size == 0) continue;
+
+        double sum = 0.0;
+        for (std::size_t r = 0; r < span.size; ++r) {
+            sum += span.rating(r);
+        }
+        means[u] = static_cast<float>(sum / static_cast<double>(span.size));
+    }
+
+    norms.assign(movieCount, 0.0f);
+    entries = 0;
+    runOffsets.assign(movieCount + 1, 0);
+    runs.clear();
+
+    for (std::size_t m = 0; m < movieCount; ++m) {
+        RaterSpan raters = byMovie.raters(static_cast<int>(m));
+        double squares = 0.0;
+
+        // Os avaliadores vêm em ordem, então as repetições de um usuário ficam lado a lado
+        for (std::size_t r = 0; r < raters.size;) {
+            int u = raters.users[r];
+            float dev = raters.rating(r) - means[u];
+            std::size_t next = r + 1;
+            while (next < raters.size && raters.users[next] == u) {
+                dev += raters.rating(next++) - means[u];
+            }
+            dev /= static_cast<float>(next - r);
+
+            if (next - r > 1) {
+                runs.push_back(RepeatedRun{static_cast<std::uint32_t>(r), static_cast<std::uint32_t>(next - r), dev});
+            }
+            ++entries;
+            squares += static_cast<double>(dev) * dev;
+            r = next;
+        }
+
+        runOffsets[m + 1] = static_cast<std::uint32_t>(runs.size());
+        norms[m] = static_cast<float>(std::sqrt(squares));
+    }
+
+    // Sem repetições (o caso do MovieLens) os offsets não são necessários
+    if (runs.empty()) {
+        std::vector<std::uint32_t>().swap(runOffsets);
+    }
+}
+
+CenteredSpan CenteredRatings::raters(const MovieRatings& byMovie, int movie) const {
+    RaterSpan raters = byMovie.raters(movie);
+    CenteredSpan span;
+    span.users = raters.users;
+    span.codes = raters.codes;
+    span.exact = raters.exact;
+    span.means = means.data();
+    span.size = raters.size;
+    if (!runOffsets.empty()) {
+        span.runs = runs.data() + runOffsets[movie];
+        span.runCount = runOffsets[movie + 1] - runOffsets[movie];
+    }
+    return span;
+}
+
+std::size_t CenteredRatings::memoryUsage() const {
+    return means.capacity() * sizeof(float) + norms.capacity() * sizeof(float) +
+           runOffsets.capacity() * sizeof(std::uint32_t) + runs.capacity() * sizeof(RepeatedRun);
+}
@@ -0,0 +1,293 @@
+#include "commands.hpp"
+#include "metrics.hpp"
+#include "queries.hpp"
+
+#include <cctype>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Maior k aceito por "fuzzy k <texto>"; acima disso quase todo título casa com textos curtos
+const int kMaxFuzzyEdits = 3;
+
+// Remove espaços nas pontas
+std::string trim(const std::string& s) {
+    std::size_t start = 0;
+    while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start]))) {
+        ++start;
+    }
+    if (start == s.size()) return "";
+
+    std::size_t end = s.size();
+    while (end > start && std::isspace(static_cast<unsigned char>(s[end - 1]))) {
+        --end;
+    }
+    return s.substr(start, end - start);
+}
+
+// Verifica se a string é formada só por dígitos
+bool isNumber(const std::string& s) {
+    if (s.empty()) return false;
+    for (char c : s) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) return false;
+    }
+    return true;
+}
+
+// Parse de tags com suporte a aspas simples:
+// tags 'dark hero' drama  -> ["dark hero", "drama"]
+// Um termo que começa entre aspas fica marcado como quoted e não é lido como operador:
+// '-1' é a tag "-1", enquanto -'dark hero' continua sendo NOT "dark hero".
+std::vector<queries::TagToken> parseTagsLine(const std::string& line) {
+    std::vector<queries::TagToken> result;
+    queries::TagToken current;
+    bool inQuotes = false;
+
+    for (char c : line) {
+        if (c == '\'') {
+            inQuotes = !inQuotes;
+            continue;
+        }
+
+        if (std::isspace(static_cast<unsigned char>(c)) && !inQuotes) {
+            if (!current.text.empty()) {
+                result.push_back(current);
+                current.text.clear();
+            }
+        } else {
+            if (current.text.empty()) current.quoted = inQuotes;
+            current.text.push_back(c);
+        }
+    }
+
+    if (!current.text.empty()) {
+        result.push_back(current);
+    }
+
+    return result;
+}
+
+// Interpreta a linha e chama a consulta; o resultado vai para sink
+void dispatch(const DataContext& ctx, const std::string& line, const commands::Options& options,
+              ResultSink& sink, std::ostream& err) {
+    std::istringstream iss(line);
+    std::string cmd;
+
+    if (!(iss >> cmd)) return;
+
+    // ---------------- PREFIX ----------------
+    if (cmd == "prefix") {
+        std::string rest;
+        std::getline(iss, rest);
+        std::string prefix = trim(rest);
+
+        // "prefix -n N <texto>": só os N melhores filmes com o prefixo. A opção não pode ser
+        // só um número na frente do texto, porque há títulos que começam com número
+        // ("101 Dalmatians"), e "prefix <texto>" tem que continuar buscando o texto inteiro.
+        if (prefix.compare(0, 3, "-n ") == 0) {
+            std::istringstream args(prefix.substr(3));
+            std::string nToken;
+            args >> nToken;
+            std::string text;
+            std::getline(args, text);
+            text = trim(text);
+
+            if (!isNumber(nToken) || nToken.size() > 9 || text.empty()) {
+                err << "Invalid prefix arguments (prefix -n N <text>)\n";
+                return;
+            }
+            int n = std::stoi(nToken);
+            if (n > 0) {
+                metrics::QueryTimer timer(metrics::Query::PrefixTop, sink);
+                queries::queryPrefixTop(ctx, sink, text, n);
+            }
+        }
+        else if (!prefix.empty()) {
+            metrics::QueryTimer timer(metrics::Query::Prefix, sink);
+            queries::queryPrefix(ctx, sink, prefix);
+        }
+    }
+
+    // ---------------- CONTAINS ----------------
+    else if (cmd == "contains") {
+        std::string rest;
+        std::getline(iss, rest);
+        std::string text = trim(rest);
+
+        if (!text.empty()) {
+            metrics::QueryTimer timer(metrics::Query::Contains, sink);
+            queries::queryContains(ctx, sink, text);
+        }
+    }
+
+    // ---------------- FUZZY ----------------
+    else if (cmd == "fuzzy") {
+        std::string kToken;
+
+        if (!(iss >> kToken)) return;
+
+        std::string rest;
+        std::getline(iss, rest);
+        std::string text = trim(rest);
+
+        if (!isNumber(kToken) || kToken.size() > 2 || std::stoi(kToken) > kMaxFuzzyEdits) {
+            err << "Invalid fuzzy arguments (k must be 0 to " << kMaxFuzzyEdits << ")\n";
+            return;
+        }
+        if (!text.empty()) {
+            metrics::QueryTimer timer(metrics::Query::Fuzzy, sink);
+            queries::queryFuzzy(ctx, sink, text, std::stoi(kToken));
+        }
+    }
+
+    // ---------------- USER ----------------
+    else if (cmd == "user") {
+        std::string userToken;
+
+        if (!(iss >> userToken)) return;
+
+        try {
+            int userId = std::stoi(userToken);
+            metrics::QueryTimer timer(metrics::Query::User, sink);
+            queries::queryUser(ctx, sink, userId);
+        }
+        catch (...) {
+            err << "Invalid user id\n";
+        }
+    }
+
+    // ---------------- MOVIE ----------------
+    else if (cmd == "movie") {
+        std::string movieToken;
+
+        if (!(iss >> movieToken)) return;
+
+        try {
+            int movieId = std::stoi(movieToken);
+            metrics::QueryTimer timer(metrics::Query::Movie, sink);
+            queries::queryMovie(ctx, sink, movieId);
+        }
+        catch (...) {
+            err << "Invalid movie id\n";
+        }
+    }
+
+    // ---------------- RECOMMEND ----------------
+    else if (cmd == "recommend") {
+        std::string userToken, nToken;
+
+        if (!(iss >> userToken >> nToken)) return;
+
+        try {
+            int userId = std::stoi(userToken);
+            int n = std::stoi(nToken);
+            if (n > 0) {
+                metrics::QueryTimer timer(metrics::Query::Recommend, sink);
+                queries::queryRecommend(ctx, sink, userId, n);
+            }
+        }
+        catch (...) {
+            err << "Invalid recommend arguments\n";
+        }
+    }
+
+    // ---------------- SIMILAR ----------------
+    else if (cmd == "similar") {
+        std::string movieToken, nToken;
+
+        if (!(iss >> movieToken >> nToken)) return;
+
+        try {
+            int movieId = std::stoi(movieToken);
+            int n = std::stoi(nToken);
+            if (n > 0) {
+                metrics::QueryTimer timer(metrics::Query::Similar, sink);
+                queries::querySimilar(ctx, sink, movieId, n, options.similarThreads);
+            }
+        }
+        catch (...) {
+            err << "Invalid similar arguments\n";
+        }
+    }
+
+    // ---------------- TOP ----------------
+    else if (cmd == "top") {
+        std::string nToken;
+
+        if (!(iss >> nToken)) return;
+
+        int n = 0;
+        try {
+            n = std::stoi(nToken);
+        }
+        catch (...) {
+            return;
+        }
+
+        std::string rest;
+        std::getline(iss, rest);
+        std::string genre = trim(rest);
+
+        if (!genre.empty() && n > 0) {
+            metrics::QueryTimer timer(metrics::Query::Top, sink);
+            queries::queryTop(ctx, sink, n, genre, options.genreMatch);
+        }
+    }
+
+    // ---------------- TAGS ----------------
+    else if (cmd == "tags") {
+
+        std::string rest;
+        std::getline(iss, rest);
+
+        auto tags = parseTagsLine(rest);
+
+        if (!tags.empty()) {
+            metrics::QueryTimer timer(metrics::Query::Tags, sink);
+            queries::queryTags(ctx, sink, tags);
+        }
+    }
+
+    // ---------------- STATS ----------------
+    else if (cmd == "stats") {
+        metrics::report(sink);
+    }
+
+    // ---------------- UNKNOWN ----------------
+    else {
+        err << "Unknown command\n";
+    }
+}
+
+} // namespace
+
+namespace commands {
+
+void execute(const DataContext& ctx, const std::string& line, const Options& options,
+             std::ostream& out, std::ostream& err) {
+    if (line.empty()) return;
+
+    switch (options.format) {
+        case OutputFormat::Json: {
+            JsonSink sink(out);
+            dispatch(ctx, line, options, sink, err);
+            sink.endResult();
+            break;
+        }
+        case OutputFormat::Tsv: {
+            TsvSink sink(out);
+            dispatch(ctx, line, options, sink, err);
+            sink.endResult();
+            break;
+        }
+        default: {
+            TableSink sink(out);
+            dispatch(ctx, line, options, sink, err);
+            sink.endResult();
+        }
+    }
+}
+
+} // namespace commands
@@ -1,17 +1,25 @@
 #include "data_loader.hpp"
+#include "mapped_file.hpp"
+#include "metrics.hpp"
+#include "similarity.hpp"
+#include "sort_utils.hpp"
+#include "thread_pool.hpp"
+#include <chrono>
 #include <fstream>
-#include <sstream>
+#include <string_view>
 #include <cctype>
+#include <climits>
+#include <cstring>
 
 namespace {
 
-// Funcao auxiliar para remover o espaço em branco da palavra
-std::string trim(const std::string& s) {
+// Funcao auxiliar para remover o espaço em branco da palavra (sem copiar: o view aponta para s)
+std::string_view trim(std::string_view s) {
     std::size_t start = 0;
     while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start]))) {
         ++start;
     }
-    if (start == s.size()) return "";
+    if (start == s.size()) return std::string_view();
 
     std::size_t end = s.size() - 1;
     while (end > start && std::isspace(static_cast<unsigned char>(s[end]))) {
@@ -20,25 +28,23 @@ std::string trim(const std::string& s) {
     return s.substr(start, end - start + 1);
 }
 
-// Deixa em minusculo a string
-std::string toLower(const std::string& s) {
-    std::string result;
-    result.reserve(s.size());
+// Escreve s em minusculo em out, reaproveitando a capacidade de out
+void toLower(std::string_view s, std::string& out) {
+    out.clear();
     for (char c : s) {
-        result.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+        out.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
     }
-    return result;
 }
 
 // Pega o ano do filme quando estiver num formato como: "Movie Name (1995)". Se não achar retorna 0.
-int extractYear(const std::string& title) {
+int extractYear(std::string_view title) {
     if (title.size() < 6) return 0;
 
     std::size_t close = title.rfind(')');
-    if (close == std::string::npos || close < 5) return 0;
+    if (close == std::string_view::npos || close < 5) return 0;
 
     std::size_t open = title.rfind('(', close);
-    if (open == std::string::npos || close - open != 5) return 0;
+    if (open == std::string_view::npos || close - open != 5) return 0;
 
     int year = 0;
     for (std::size_t i = open + 1; i < close; ++i) {
@@ -50,22 +56,170 @@ int extractYear(const std::string& title) {
     return year;
 }
 
+// Limites do campo [begin, end) que começa em p: vai até a próxima vírgula ou o fim da linha.
+// Retorna o início do próximo campo, ou nullptr se não houver vírgula.
+const char* nextField(const char* p, const char* lineEnd, const char*& fieldEnd) {
+    const char* comma = static_cast<const char*>(std::memchr(p, ',', static_cast<std::size_t>(lineEnd - p)));
+    if (comma == nullptr) {
+        fieldEnd = lineEnd;
+        return nullptr;
+    }
+    fieldEnd = comma;
+    return comma + 1;
+}
+
+// Parse de inteiro direto no buffer, com a mesma tolerância do std::stoi:
+// ignora espaços à esquerda, aceita sinal e para no primeiro caractere que não for dígito.
+bool parseInt(const char* p, const char* end, int& out) {
+    while (p < end && std::isspace(static_cast<unsigned char>(*p))) ++p;
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    const char* digits = p;
+    long long value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        if (value > static_cast<long long>(INT_MAX) + 1) return false;
+        ++p;
+    }
+    if (p == digits) return false;
+
+    if (negative) value = -value;
+    if (value > INT_MAX || value < INT_MIN) return false;
+    out = static_cast<int>(value);
+    return true;
+}
+
+// Parse da nota em ponto fixo: "3.5" vira mantissa 35 com 1 casa decimal.
+// As notas do MovieLens têm no máximo uma casa, então a divisão final é exata.
+bool parseRating(const char* p, const char* end, float& out) {
+    static const double pow10[] = {1.0, 10.0, 100.0, 1000.0, 10000.0, 100000.0, 1000000.0};
+
+    while (p < end && std::isspace(static_cast<unsigned char>(*p))) ++p;
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    long long mantissa = 0;
+    int digits = 0;
+    int decimals = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (digits < 15) {
+            mantissa = mantissa * 10 + (*p - '0');
+            ++digits;
+        }
+        ++p;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (decimals < 6 && digits < 15) {
+                mantissa = mantissa * 10 + (*p - '0');
+                ++decimals;
+            }
+            ++digits;
+            ++p;
+        }
+    }
+    if (digits == 0) return false;
+
+    double value = static_cast<double>(mantissa) / pow10[decimals];
+    out = static_cast<float>(negative ? -value : value);
+    return true;
+}
+
+// Percorre as linhas de ratings em [p, end) chamando fn(userId, movieId, rating)
+// para cada linha válida. Linhas malformadas são ignoradas, como no parse com stoi/stof.
+template <typename Fn>
+std::size_t forEachRating(const char* p, const char* end, Fn fn) {
+    std::size_t rows = 0;
+
+    while (p < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        if (lineEnd == nullptr) lineEnd = end;
+        const char* line = p;
+        p = lineEnd + 1;
+
+        if (line == lineEnd) continue;
+
+        const char* userIdEnd = nullptr;
+        const char* movieIdEnd = nullptr;
+        const char* ratingEnd = nullptr;
+
+        const char* movieIdField = nextField(line, lineEnd, userIdEnd);
+        if (movieIdField == nullptr) continue;
+        const char* ratingField = nextField(movieIdField, lineEnd, movieIdEnd);
+        if (ratingField == nullptr) continue;
+        nextField(ratingField, lineEnd, ratingEnd);
+        // Ignora demais campos que podem ser ignorados, como timestamp, por exemplo
+
+        int userId = 0;
+        int movieId = 0;
+        float rating = 0.0f;
+
+        //faz o parse para int dos dados lidos
+        if (!parseInt(line, userIdEnd, userId)) continue;
+        if (!parseInt(movieIdField, movieIdEnd, movieId)) continue;
+        if (!parseRating(ratingField, ratingEnd, rating)) continue;
+
+        fn(userId, movieId, rating);
+        ++rows;
+    }
+
+    return rows;
+}
+
+// Pula a header do csv; retorna nullptr se o arquivo estiver vazio ou só tiver uma linha
+// (arquivo vazio não é mapeado e data() é nullptr, que não pode ir para o memchr)
+const char* skipHeader(const MappedFile& file) {
+    if (file.size() == 0) {
+        return nullptr;
+    }
+    const char* headerEnd = static_cast<const char*>(std::memchr(file.data(), '\n', file.size()));
+    return headerEnd == nullptr ? nullptr : headerEnd + 1;
+}
+
+// Quantos melhores filmes cada nó da TRIE guarda para as consultas "prefix -n N"
+const std::size_t kPrefixTopCache = 50;
+
+// Mínimo de avaliações para um filme aparecer na consulta top (requisito do enunciado)
+const int kTopMinRatings = 1000;
+
+// Tags com menos filmes que isso não ganham bitmap: a lista ordenada já é menor
+// que um bitmap e é convertida na hora da consulta
+const std::size_t kTagBitmapMinSize = 64;
+
+double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
 } // namespace
 
 namespace data_loader {
 //adiciona os filmes na tabela hash e insere os titulos na trie
 void loadMovies(const std::string& path, DataContext& ctx) {
+    metrics::LoadTimer timer(metrics::LoadPhase::Movies);
     std::ifstream file(path);
     if (!file.is_open()) {
         return;
     }
 
+    // line é reaproveitada a cada getline e os campos são views dentro dela: depois que o
+    // buffer cresce até a maior linha, o parse não aloca nada
     std::string line;
     // Ignora a header do csv
     if (!std::getline(file, line)) {
         return;
     }
 
+    std::size_t rows = 0;
     while (std::getline(file, line)) {
         if (line.empty()) continue;
 
@@ -73,24 +227,19 @@ void loadMovies(const std::string& path, DataContext& ctx) {
         std::size_t firstComma = line.find(',');
         if (firstComma == std::string::npos) continue;
 
-        std::string movieIdStr = line.substr(0, firstComma);
-        std::string rest = line.substr(firstComma + 1);
+        std::string_view rest = std::string_view(line).substr(firstComma + 1);
 
         int movieId = 0;
-        try {
-            //converte de string pra inteiro
-            movieId = std::stoi(movieIdStr);
-        } catch (...) {
-            continue;
-        }
+        //converte de string pra inteiro
+        if (!parseInt(line.data(), line.data() + firstComma, movieId)) continue;
 
-        std::string title;
-        std::string genres;
+        std::string_view title;
+        std::string_view genres;
 
         if (!rest.empty() && rest[0] == '"') {
             // Verifica se o titulo contém aspas
             std::size_t endQuote = rest.find('"', 1);
-            if (endQuote == std::string::npos) {
+            if (endQuote == std::string_view::npos) {
                 // npos --> posição invalida
                 continue;
             }
@@ -106,10 +255,10 @@ void loadMovies(const std::string& path, DataContext& ctx) {
         } else {
             // Caso de titulo sem aspas
             std::size_t secondComma = rest.find(',');
-            if (secondComma == std::string::npos) {
+            if (secondComma == std::string_view::npos) {
                 // Pega os generos dos filmes
                 title = rest;
-                genres.clear();
+                genres = std::string_view();
             } else {
                 title = rest.substr(0, secondComma);
                 genres = rest.substr(secondComma + 1);
@@ -120,103 +269,258 @@ void loadMovies(const std::string& path, DataContext& ctx) {
         genres = trim(genres);
         int year = extractYear(title);
 
-        // Insere o filme na tabela hash de filmes referenciando uma instânia da classe Movie e
-        //chamando a função que adiciona ou retorna o filme
-        Movie& m = ctx.movies.insertOrGet(movieId);
-        m.movieId = movieId;
-        m.title = title;
-        m.genres = genres;
-        m.year = year;
+        // Insere o filme no catálogo (ou pega o índice dele, se o id se repetir) e grava os textos
+        int idx = ctx.movies.insertOrGet(movieId);
+        ctx.movies.setInfo(idx, title, genres, year);
 
         // Insere o título na trie para buscas por prefixo
         ctx.trie.insert(title, movieId);
+        ++rows;
     }
+    timer.setRows(rows);
 }
 
 void loadRatings(const std::string& path, DataContext& ctx) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
+    metrics::LoadTimer timer(metrics::LoadPhase::Ratings);
+    // O arquivo é mapeado em memória e os campos são lidos no próprio buffer,
+    // sem alocar strings por linha
+    MappedFile file(path);
+    if (!file.isOpen()) {
         return;
     }
 
-    std::string line;
-    if (!std::getline(file, line)) {
+    const char* begin = skipHeader(file);
+    if (begin == nullptr) {
         return;
     }
-    
+
     //percorre o arquivo linha por linha
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
+    std::size_t rows = forEachRating(begin, file.data() + file.size(), [&ctx](int userId, int movieId, float rating) {
+        //para cada filme achado (vai apenas executar o "get" do insertOrGet, pois os filmes ja foram inseridos no loadMovies)
+        //atualiza a contagem de ratings e a soma dos ratings, nao cria uma nova tabela, apenas atualiza os valores
+        ctx.movies.addRating(ctx.movies.insertOrGet(movieId), static_cast<double>(rating));
 
-        std::stringstream ss(line);
-        std::string userIdStr, movieIdStr, ratingStr;
+        //registra a avaliação do usuário; as avaliações são agrupadas por usuário (CSR) em buildIndexes
+        ctx.users.addRating(ctx.users.insertOrGet(userId), movieId, rating);
+    });
+    timer.setRows(rows);
+}
 
-        if (!std::getline(ss, userIdStr, ',')) continue;
-        if (!std::getline(ss, movieIdStr, ',')) continue;
-        if (!std::getline(ss, ratingStr, ',')) continue;
-        // Ignora demais campos que podem ser ignorados, como timestamp, por exemplo
+// Versão paralela do loadRatings: o arquivo é dividido em blocos alinhados em '\n',
+// cada bloco é lido por uma thread do pool em tabelas parciais (soma/contagem por filme
+// e avaliações por usuário) e as parciais são juntadas na ordem dos blocos.
+// Como a junção segue a ordem do arquivo, as avaliações de cada usuário ficam na mesma
+// ordem do loader serial. As notas do MovieLens são múltiplos de 0.5, então as somas
+// parciais são exatas e ratingSum sai idêntico ao serial.
+RatingsLoadStats loadRatingsParallel(const std::string& path, DataContext& ctx, unsigned threads) {
+    metrics::LoadTimer timer(metrics::LoadPhase::Ratings);
+    RatingsLoadStats stats;
+    auto phaseStart = std::chrono::steady_clock::now();
+
+    MappedFile file(path);
+    if (!file.isOpen()) {
+        return stats;
+    }
 
-        int userId = 0;
-        int movieId = 0;
-        float rating = 0.0f;
+    const char* begin = skipHeader(file);
+    if (begin == nullptr) {
+        return stats;
+    }
+    const char* end = file.data() + file.size();
+    // Só a header: não há blocos para dividir
+    if (begin == end) {
+        return stats;
+    }
 
-        //faz o parse para int dos dados lidos
-        try {
-            userId = std::stoi(userIdStr);
-            movieId = std::stoi(movieIdStr);
-            rating = std::stof(ratingStr);
-        } catch (...) {
-            continue;
+    std::size_t chunkCount = threads == 0 ? 1 : threads;
+
+    // Fronteiras dos blocos: cada uma avança até logo depois do próximo '\n'
+    std::vector<const char*> bounds;
+    bounds.push_back(begin);
+    for (std::size_t i = 1; i < chunkCount; ++i) {
+        const char* cut = begin + static_cast<std::size_t>(end - begin) * i / chunkCount;
+        if (cut < bounds.back()) cut = bounds.back();
+        const char* nl = static_cast<const char*>(std::memchr(cut, '\n', static_cast<std::size_t>(end - cut)));
+        bounds.push_back(nl == nullptr ? end : nl + 1);
+    }
+    bounds.push_back(end);
+
+    // Soma/contagem de um filme que não está no catálogo (só aparece no ratings.csv)
+    struct MovieTotals {
+        int count = 0;
+        double sum = 0.0;
+    };
+
+    // Os filmes do catálogo são acumulados em arrays indexados pelo índice denso (o catálogo
+    // só é lido durante o parse); os demais vão para uma tabela própria do bloco
+    struct Partial {
+        std::vector<int> counts;
+        std::vector<double> sums;
+        hash_table::OpenHashTable<int, MovieTotals, hash_table::IntHash> unknownMovies;
+        UserStore users; // só a preparação, com índices de usuário locais ao bloco
+        std::size_t rows = 0;
+
+        explicit Partial(std::size_t catalogSize) : counts(catalogSize, 0), sums(catalogSize, 0.0) {}
+    };
+
+    const MovieStore& catalog = ctx.movies;
+
+    std::vector<Partial> partials;
+    partials.reserve(chunkCount);
+    for (std::size_t i = 0; i < chunkCount; ++i) {
+        partials.emplace_back(catalog.size());
+    }
+
+    stats.splitMs = elapsedMs(phaseStart);
+    phaseStart = std::chrono::steady_clock::now();
+
+    {
+        ThreadPool pool(chunkCount);
+        for (std::size_t i = 0; i < chunkCount; ++i) {
+            pool.submit([&partials, &bounds, &catalog, i] {
+                Partial& part = partials[i];
+                part.rows = forEachRating(bounds[i], bounds[i + 1], [&part, &catalog](int userId, int movieId, float rating) {
+                    int idx = catalog.indexOf(movieId);
+                    if (idx >= 0) {
+                        part.counts[idx] += 1;
+                        part.sums[idx] += static_cast<double>(rating);
+                    } else {
+                        bool inserted = false;
+                        MovieTotals& t = part.unknownMovies.insertOrGet(movieId, inserted);
+                        t.count += 1;
+                        t.sum += static_cast<double>(rating);
+                    }
+
+                    part.users.addRating(part.users.insertOrGet(userId), movieId, rating);
+                });
+            });
         }
+        pool.wait();
+    }
 
-        //para cada filme achado (vai apenas executar o "get" do insertOrGet, pois os filmes ja foram inseridos no loadMovies)
-        //atualiza a contagem de ratings e a soma dos ratings, nao cria uma nova tabela, apenas atualiza os valores
-        Movie& m = ctx.movies.insertOrGet(movieId);
-        m.ratingCount += 1;
-        m.ratingSum += static_cast<double>(rating);
+    stats.parseMs = elapsedMs(phaseStart);
+    phaseStart = std::chrono::steady_clock::now();
+
+    // Junta as parciais na ordem dos blocos
+    for (Partial& part : partials) {
+        stats.rows += part.rows;
 
-        //insere a avaliação do usuário na tabela hash de usuários (agora sim, cria uma tabela para registro de cada usuario e suas avaliações)
-        User& u = ctx.users.insertOrGet(userId);
-        u.userId = userId;
-        u.ratings.push_back(UserRating{movieId, rating});
+        for (std::size_t idx = 0; idx < part.counts.size(); ++idx) {
+            if (part.counts[idx] == 0) continue;
+            ctx.movies.addRatings(static_cast<int>(idx), part.counts[idx], part.sums[idx]);
+        }
+        part.unknownMovies.forEach([&ctx](int movieId, const MovieTotals& t) {
+            ctx.movies.addRatings(ctx.movies.insertOrGet(movieId), t.count, t.sum);
+        });
+
+        ctx.users.append(part.users);
+        part.users = UserStore();
     }
+
+    stats.mergeMs = elapsedMs(phaseStart);
+    timer.setRows(stats.rows);
+    return stats;
 }
 
 void loadTags(const std::string& path, DataContext& ctx) {
+    metrics::LoadTimer timer(metrics::LoadPhase::Tags);
     std::ifstream file(path);
     if (!file.is_open()) {
         return;
     }
 
+    // Como em loadMovies, line e normalizedTag são reaproveitadas entre as linhas
     std::string line;
+    std::string normalizedTag;
     // Ignora a header do csv
     if (!std::getline(file, line)) {
         return;
     }
 
+    std::size_t rows = 0;
     while (std::getline(file, line)) {
         if (line.empty()) continue;
 
-        std::stringstream ss(line);
-        std::string userIdStr, movieIdStr, tagStr, timestampStr;
-
-        if (!std::getline(ss, userIdStr, ',')) continue;
-        if (!std::getline(ss, movieIdStr, ',')) continue;
-        if (!std::getline(ss, tagStr, ',')) continue;
-        std::getline(ss, timestampStr);
+        // userId,movieId,tag[,timestamp]: sem a segunda vírgula não há tag
+        const char* lineEnd = line.data() + line.size();
+        const char* fieldEnd = nullptr;
+        const char* movieField = nextField(line.data(), lineEnd, fieldEnd);
+        if (movieField == nullptr) continue;
+        const char* tagField = nextField(movieField, lineEnd, fieldEnd);
+        if (tagField == nullptr) continue;
 
         int movieId = 0;
-        try {
-            movieId = std::stoi(movieIdStr);
-        } catch (...) {
-            continue;
-        }
+        if (!parseInt(movieField, tagField - 1, movieId)) continue;
 
-        std::string normalizedTag = toLower(trim(tagStr));
+        nextField(tagField, lineEnd, fieldEnd);
+        toLower(trim(std::string_view(tagField, static_cast<std::size_t>(fieldEnd - tagField))), normalizedTag);
         if (normalizedTag.empty()) continue;
 
         ctx.tags.addMovie(normalizedTag, movieId);
+        ++rows;
     }
+    timer.setRows(rows);
+}
+
+void buildIndexes(DataContext& ctx) {
+    metrics::LoadTimer timer(metrics::LoadPhase::Indexes);
+    // Avaliações de cada usuário em um único CSR
+    ctx.users.finalize(ctx.movies);
+    // e a mesma informação agrupada por filme
+    ctx.movieRatings.build(ctx.users, ctx.movies.size());
+    ctx.centered.build(ctx.users, ctx.movieRatings);
+
+    struct Ranked {
+        int movieId;
+        double avg;
+        int ratingCount;
+    };
+
+    std::vector<Ranked> ranked;
+    // Varredura só sobre as colunas de avaliações do catálogo
+    const std::vector<int>& ids = ctx.movies.movieIds();
+    const std::vector<int>& counts = ctx.movies.ratingCountColumn();
+    const std::vector<double>& sums = ctx.movies.ratingSumColumn();
+    ranked.reserve(ids.size());
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        if (counts[i] <= 0) continue;
+        ranked.push_back(Ranked{ids[i], sums[i] / static_cast<double>(counts[i]), counts[i]});
+    }
+
+    // Mesma ordem usada pelas consultas: média desc, depois ratingCount desc, depois movieId asc
+    sort_utils::quickSort(ranked, [](const Ranked& a, const Ranked& b) {
+        if (a.avg != b.avg) return a.avg > b.avg;
+        if (a.ratingCount != b.ratingCount) return a.ratingCount > b.ratingCount;
+        return a.movieId < b.movieId;
+    });
+
+    ctx.rankedMovies.clear();
+    ctx.rankedMovies.reserve(ranked.size());
+    for (const Ranked& r : ranked) {
+        ctx.rankedMovies.push_back(r.movieId);
+    }
+
+    ctx.trie.buildTopCache(ctx.rankedMovies, kPrefixTopCache);
+    ctx.titleIndex.build(ctx.movies);
+    ctx.genreIndex.build(ctx.rankedMovies, ctx.movies, kTopMinRatings);
+
+    // Listas de filmes das tags ordenadas e sem duplicatas, para as interseções
+    ctx.tags.finalize();
+
+    // Índices densos dos filmes e bitmaps das tags, para as consultas com OR/NOT
+    ctx.denseMovieIds.assign(ids.begin(), ids.end());
+    sort_utils::quickSort(ctx.denseMovieIds, [](int a, int b) { return a < b; });
+
+    ctx.tags.buildBitmaps(ctx.denseMovieIds, kTagBitmapMinSize);
+    timer.setRows(ctx.users.ratingCount());
+}
+
+double buildNeighbors(DataContext& ctx, std::size_t k, unsigned threads) {
+    metrics::LoadTimer timer(metrics::LoadPhase::Neighbors);
+    auto start = std::chrono::steady_clock::now();
+    ctx.neighbors.build(ctx.movies, ctx.movieRatings, ctx.centered, k, similarity::kMinCommonRaters, threads);
+    timer.setRows(ctx.neighbors.pairCount());
+    return elapsedMs(start);
 }
 
-} // namespace data_loader
\ No newline at end of file
+} // namespace data_loader
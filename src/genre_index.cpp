@@ -0,0 +1,123 @@
+#include "genre_index.hpp"
+
+#include <cctype>
+
+namespace {
+
+// O campo genres vem como "Adventure|Animation,1995": os nomes ficam antes da vírgula
+bool hasGenre(std::string_view genres, const std::string& name) {
+    std::string_view list = genres.substr(0, genres.find(','));
+    std::size_t start = 0;
+    while (start <= list.size()) {
+        std::size_t bar = list.find('|', start);
+        if (bar == std::string::npos) bar = list.size();
+        if (list.compare(start, bar - start, name) == 0) return true;
+        start = bar + 1;
+    }
+    return false;
+}
+
+int findGenre(const std::vector<std::string>& names, const std::string& name) {
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+} // namespace
+
+void GenreIndex::build(const std::vector<int>& ranked, const MovieStore& movies, int minRatings) {
+    eligible.clear();
+    byGenre.clear();
+    byGenre.resize(movies.genreNames().size());
+    anyIrregular = false;
+
+    for (int movieId : ranked) {
+        int idx = movies.indexOf(movieId);
+        if (idx < 0 || movies.ratingCount(idx) < minRatings) continue;
+
+        std::size_t pos = eligible.size();
+        std::uint64_t mask = movies.genreMask(idx);
+        while (mask != 0) {
+            int bit = __builtin_ctzll(mask);
+            byGenre[bit].push_back(static_cast<int>(pos));
+            mask &= mask - 1;
+        }
+
+        eligible.push_back(idx);
+        if (movies.irregularGenres(idx)) anyIrregular = true;
+    }
+}
+
+std::vector<int> GenreIndex::top(const MovieStore& movies, const std::string& genre,
+                                 GenreMatch match, std::size_t n) const {
+    std::vector<int> result;
+
+    if (match == GenreMatch::Exact) {
+        int id = findGenre(movies.genreNames(), genre);
+        if (id != -1) {
+            // Caso comum: uma fatia da lista pré-ordenada do gênero
+            const std::vector<int>& list = byGenre[id];
+            for (std::size_t i = 0; i < list.size() && result.size() < n; ++i) {
+                result.push_back(eligible[list[i]]);
+            }
+            return result;
+        }
+        // Gênero fora da máscara: só pode estar em filmes marcados como irregulares
+        for (std::size_t i = 0; i < eligible.size() && result.size() < n; ++i) {
+            if (movies.irregularGenres(eligible[i]) && hasGenre(movies.genres(eligible[i]), genre)) {
+                result.push_back(eligible[i]);
+            }
+        }
+        return result;
+    }
+
+    // Substring: textos com '|', ',' ou dígitos podem casar entre gêneros ou com o ano,
+    // então são comparados direto com o campo de gêneros de cada filme elegível
+    bool literal = false;
+    for (char c : genre) {
+        if (c == '|' || c == ',' || std::isdigit(static_cast<unsigned char>(c))) literal = true;
+    }
+    if (literal) {
+        for (std::size_t i = 0; i < eligible.size() && result.size() < n; ++i) {
+            if (movies.genres(eligible[i]).find(genre) != std::string_view::npos) {
+                result.push_back(eligible[i]);
+            }
+        }
+        return result;
+    }
+
+    // Senão, o texto casa com um filme se e só se estiver no nome de algum dos seus gêneros
+    std::uint64_t matchMask = 0;
+    int matches = 0;
+    int lastMatch = -1;
+    const std::vector<std::string>& names = movies.genreNames();
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        if (names[i].find(genre) != std::string::npos) {
+            matchMask |= std::uint64_t(1) << i;
+            ++matches;
+            lastMatch = static_cast<int>(i);
+        }
+    }
+
+    if (matches == 1 && !anyIrregular) {
+        const std::vector<int>& list = byGenre[lastMatch];
+        for (std::size_t i = 0; i < list.size() && result.size() < n; ++i) {
+            result.push_back(eligible[list[i]]);
+        }
+        return result;
+    }
+
+    for (std::size_t i = 0; i < eligible.size() && result.size() < n; ++i) {
+        bool hit = (movies.genreMask(eligible[i]) & matchMask) != 0;
+        if (!hit && movies.irregularGenres(eligible[i])) {
+            hit = movies.genres(eligible[i]).find(genre) != std::string_view::npos;
+        }
+        if (hit) result.push_back(eligible[i]);
+    }
+    return result;
+}
+
+std::size_t GenreIndex::genreCount() const {
+    return byGenre.size();
+}
@@ -0,0 +1,141 @@
+#include "intersect.hpp"
+#include "sort_utils.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// A partir de qual razão entre os tamanhos a busca galopante compensa mais que o merge
+const std::size_t kGallopRatio = 32;
+
+// Primeira posição em [lo, size) com arr[pos] >= value, com passos exponenciais a partir de lo
+std::size_t gallopLowerBound(const int* arr, std::size_t lo, std::size_t size, int value) {
+    std::size_t step = 1;
+    std::size_t hi = lo;
+    while (hi < size && arr[hi] < value) {
+        lo = hi + 1;
+        hi += step;
+        step <<= 1;
+    }
+    if (hi > size) hi = size;
+
+    // Busca binária em [lo, hi)
+    while (lo < hi) {
+        std::size_t mid = lo + (hi - lo) / 2;
+        if (arr[mid] < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void mergeScalar(const int* a, std::size_t aSize, std::size_t i,
+                 const int* b, std::size_t bSize, std::size_t j,
+                 std::vector<int>& out) {
+    while (i < aSize && j < bSize) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            out.push_back(a[i]);
+            ++i;
+            ++j;
+        }
+    }
+}
+
+} // namespace
+
+namespace intersect {
+
+void galloping(const int* small, std::size_t smallSize,
+               const int* large, std::size_t largeSize,
+               std::vector<int>& out) {
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < smallSize && pos < largeSize; ++i) {
+        pos = gallopLowerBound(large, pos, largeSize, small[i]);
+        if (pos < largeSize && large[pos] == small[i]) {
+            out.push_back(small[i]);
+            ++pos;
+        }
+    }
+}
+
+void merge(const int* a, std::size_t aSize,
+           const int* b, std::size_t bSize,
+           std::vector<int>& out) {
+    std::size_t i = 0;
+    std::size_t j = 0;
+
+#if defined(__SSE2__)
+    // Compara um bloco de 4 de a contra as 4 rotações de um bloco de 4 de b;
+    // cada bit da máscara indica um elemento de a presente no bloco de b.
+    // Avança o bloco cujo último elemento é menor (ou os dois, se forem iguais).
+    while (i + 4 <= aSize && j + 4 <= bSize) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+
+        __m128i eq = _mm_cmpeq_epi32(va, vb);
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        for (int k = 0; mask != 0; ++k, mask >>= 1) {
+            if (mask & 1) out.push_back(a[i + k]);
+        }
+
+        int lastA = a[i + 3];
+        int lastB = b[j + 3];
+        if (lastA <= lastB) i += 4;
+        if (lastB <= lastA) j += 4;
+    }
+#endif
+
+    mergeScalar(a, aSize, i, b, bSize, j, out);
+}
+
+void intersectPair(const std::vector<int>& a, const std::vector<int>& b, std::vector<int>& out) {
+    intersectPair(a.data(), a.size(), b.data(), b.size(), out);
+}
+
+void intersectPair(const int* a, std::size_t aSize, const int* b, std::size_t bSize, std::vector<int>& out) {
+    const int* small = aSize <= bSize ? a : b;
+    const int* large = aSize <= bSize ? b : a;
+    std::size_t smallSize = aSize <= bSize ? aSize : bSize;
+    std::size_t largeSize = aSize <= bSize ? bSize : aSize;
+
+    if (smallSize == 0) return;
+
+    if (largeSize / smallSize >= kGallopRatio) {
+        galloping(small, smallSize, large, largeSize, out);
+    } else {
+        merge(small, smallSize, large, largeSize, out);
+    }
+}
+
+void intersectAll(std::vector<const std::vector<int>*> lists, std::vector<int>& out) {
+    out.clear();
+    if (lists.empty()) return;
+
+    // Da menor para a maior: o resultado parcial só diminui
+    sort_utils::quickSort(lists, [](const std::vector<int>* x, const std::vector<int>* y) {
+        return x->size() < y->size();
+    });
+
+    out = *lists[0];
+
+    std::vector<int> next;
+    for (std::size_t i = 1; i < lists.size() && !out.empty(); ++i) {
+        next.clear();
+        intersectPair(out, *lists[i], next);
+        out.swap(next);
+    }
+}
+
+} // namespace intersect
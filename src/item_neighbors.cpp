@@ -0,0 +1,201 @@
+#include "item_neighbors.hpp"
+#include "sort_utils.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace {
+
+// Filmes por bloco; cada thread pega o próximo bloco livre, o que equilibra filmes com muitos
+// e poucos avaliadores (e o fato de os primeiros filmes terem mais pares para calcular)
+const std::size_t kMoviesPerBlock = 64;
+
+// Avaliação no histórico ordenado de um usuário
+struct Entry {
+    std::int32_t movie;
+    float dev;
+};
+
+// Soma dos produtos dos desvios e nº de usuários em comum de um par (i, j)
+struct Accumulator {
+    float dot;
+    std::uint32_t common;
+};
+
+struct Candidate {
+    std::int32_t movie;
+    int movieId;
+    float sim;
+};
+
+// Maior similaridade primeiro; no empate, o menor movieId
+bool closer(const Candidate& a, const Candidate& b) {
+    if (a.sim != b.sim) return a.sim > b.sim;
+    return a.movieId < b.movieId;
+}
+
+// Os k melhores vizinhos de cada filme vistos por uma thread
+struct PartialNeighbors {
+    std::vector<Candidate> heaps;   // k posições por filme
+    std::vector<std::size_t> sizes;
+    std::vector<float> worst;       // pior similaridade de um heap cheio (-1 enquanto não encher)
+
+    PartialNeighbors(std::size_t movieCount, std::size_t k)
+        : heaps(movieCount * k), sizes(movieCount, 0), worst(movieCount, -1.0f) {}
+};
+
+} // namespace
+
+void ItemNeighbors::build(const MovieStore& movies, const MovieRatings& byMovie, const CenteredRatings& centered,
+                          std::size_t neighborCount, std::size_t minCommon, unsigned threads) {
+    k = neighborCount;
+    std::size_t movieCount = centered.movieCount();
+    std::size_t userCount = centered.userCount();
+
+    // Histórico de cada usuário em desvios: transposta do CSR por filme, com os desvios
+    // calculados na hora. Percorrer os filmes em ordem já deixa cada histórico ordenado por filme.
+    std::vector<std::uint64_t> userOffsets(userCount + 1, 0);
+    for (std::size_t m = 0; m < movieCount; ++m) {
+        centered.raters(byMovie, static_cast<int>(m)).forEach([&](int user, float) {
+            ++userOffsets[user + 1];
+        });
+    }
+    for (std::size_t u = 0; u < userCount; ++u) {
+        userOffsets[u + 1] += userOffsets[u];
+    }
+
+    std::vector<Entry> entries(centered.entryCount());
+    std::vector<std::uint64_t> next(userOffsets.begin(), userOffsets.end() - 1);
+    for (std::size_t m = 0; m < movieCount; ++m) {
+        centered.raters(byMovie, static_cast<int>(m)).forEach([&](int user, float dev) {
+            entries[next[user]++] = Entry{static_cast<std::int32_t>(m), dev};
+        });
+    }
+
+    // A similaridade é simétrica: o par (i, j) só é calculado quando i < j, percorrendo nos
+    // históricos ordenados só os filmes depois de i, e entra nos vizinhos dos dois filmes
+    unsigned workers = threads == 0 ? 1 : threads;
+    std::vector<PartialNeighbors> partials;
+    partials.reserve(workers);
+    for (unsigned t = 0; t < workers; ++t) {
+        partials.emplace_back(movieCount, k);
+    }
+    std::atomic<std::size_t> nextBlock(0);
+
+    auto work = [&](PartialNeighbors& part) {
+        std::vector<Accumulator> acc(movieCount, Accumulator{0.0f, 0});
+        auto push = [&](std::size_t movie, const Candidate& c) {
+            sort_utils::pushBounded(part.heaps.data() + movie * k, part.sizes[movie], k, c, closer);
+            if (part.sizes[movie] == k) part.worst[movie] = part.heaps[movie * k].sim;
+        };
+
+        for (;;) {
+            std::size_t first = nextBlock.fetch_add(1) * kMoviesPerBlock;
+            if (first >= movieCount) return;
+            std::size_t last = first + kMoviesPerBlock < movieCount ? first + kMoviesPerBlock : movieCount;
+
+            for (std::size_t i = first; i < last; ++i) {
+                float normI = centered.norm(static_cast<int>(i));
+                if (normI == 0.0f) continue;
+
+                std::size_t furthest = i;
+                centered.raters(byMovie, static_cast<int>(i)).forEach([&](int u, float) {
+                    const Entry* begin = entries.data() + userOffsets[u];
+                    const Entry* end = entries.data() + userOffsets[u + 1];
+                    const Entry* self = std::lower_bound(begin, end, static_cast<std::int32_t>(i),
+                        [](const Entry& e, std::int32_t movie) { return e.movie < movie; });
+                    if (self == end) return;
+
+                    float dev = self->dev;
+                    for (const Entry* e = self + 1; e < end; ++e) {
+                        acc[e->movie].dot += dev * e->dev;
+                        ++acc[e->movie].common;
+                    }
+                    if (end - 1 > self && static_cast<std::size_t>((end - 1)->movie) > furthest) {
+                        furthest = static_cast<std::size_t>((end - 1)->movie);
+                    }
+                });
+
+                int movieId = movies.movieId(static_cast<int>(i));
+                for (std::size_t j = i + 1; j <= furthest; ++j) {
+                    Accumulator a = acc[j];
+                    if (a.common == 0) continue;
+                    acc[j] = Accumulator{0.0f, 0};
+
+                    float normJ = centered.norm(static_cast<int>(j));
+                    if (a.common < minCommon || a.dot <= 0.0f || normJ == 0.0f) continue;
+                    float sim = a.dot / (normI * normJ);
+                    // Quase todos os pares ficam abaixo do pior vizinho já guardado; esses nem chegam ao heap
+                    if (sim >= part.worst[i]) {
+                        push(i, Candidate{static_cast<std::int32_t>(j), movies.movieId(static_cast<int>(j)), sim});
+                    }
+                    if (sim >= part.worst[j]) {
+                        push(j, Candidate{static_cast<std::int32_t>(i), movieId, sim});
+                    }
+                }
+            }
+        }
+    };
+
+    if (k > 0) {
+        ThreadPool pool(workers);
+        for (unsigned t = 0; t < workers; ++t) {
+            PartialNeighbors* part = &partials[t];
+            pool.submit([&work, part] { work(*part); });
+        }
+        pool.wait();
+    }
+
+    // Junta os vizinhos vistos por cada thread e fica com os k melhores de cada filme
+    offsets.assign(movieCount + 1, 0);
+    std::size_t total = 0;
+    for (std::size_t m = 0; m < movieCount; ++m) {
+        std::size_t seen = 0;
+        for (const PartialNeighbors& part : partials) {
+            seen += part.sizes[m];
+        }
+        total += seen < k ? seen : k;
+    }
+    neighborMovies.clear();
+    neighborSims.clear();
+    neighborMovies.reserve(total);
+    neighborSims.reserve(total);
+    std::vector<Candidate> merged;
+    for (std::size_t m = 0; m < movieCount && k > 0; ++m) {
+        merged.clear();
+        for (const PartialNeighbors& part : partials) {
+            const Candidate* heap = part.heaps.data() + m * k;
+            merged.insert(merged.end(), heap, heap + part.sizes[m]);
+        }
+        sort_utils::selectTop(merged, k, closer);
+        for (const Candidate& c : merged) {
+            neighborMovies.push_back(c.movie);
+            neighborSims.push_back(c.sim);
+        }
+        offsets[m + 1] = static_cast<std::uint32_t>(neighborMovies.size());
+    }
+}
+
+void ItemNeighbors::assign(std::size_t neighborCount, std::vector<std::uint32_t> movieOffsets,
+                           std::vector<std::int32_t> movies, std::vector<float> sims) {
+    k = neighborCount;
+    offsets = std::move(movieOffsets);
+    neighborMovies = std::move(movies);
+    neighborSims = std::move(sims);
+}
+
+NeighborSpan ItemNeighbors::neighbors(int movie) const {
+    NeighborSpan span;
+    if (static_cast<std::size_t>(movie) + 1 >= offsets.size()) return span;
+    span.movies = neighborMovies.data() + offsets[movie];
+    span.sims = neighborSims.data() + offsets[movie];
+    span.size = offsets[movie + 1] - offsets[movie];
+    return span;
+}
+
+std::size_t ItemNeighbors::memoryUsage() const {
+    return offsets.capacity() * sizeof(std::uint32_t) + neighborMovies.capacity() * sizeof(std::int32_t) +
+           neighborSims.capacity() * sizeof(float);
+}
@@ -1,158 +1,312 @@
 
+#include <chrono>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <vector>
-#include <cctype>
 
+#include "commands.hpp"
 #include "context.hpp"
 #include "data_loader.hpp"
-#include "queries.hpp"
+#include "server.hpp"
+#include "snapshot.hpp"
+#include "work_stealing_pool.hpp"
 
 /* ------------------------------------------------------------------
    Helpers
 ------------------------------------------------------------------ */
 
-// Remove espaços nas pontas
 namespace {
-std::string trim(const std::string& s) {
-    std::size_t start = 0;
-    while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start]))) {
-        ++start;
-    }
-    if (start == s.size()) return "";
-
-    std::size_t end = s.size();
-    while (end > start && std::isspace(static_cast<unsigned char>(s[end - 1]))) {
-        --end;
-    }
-    return s.substr(start, end - start);
-}
-}
 
-// Parse de tags com suporte a aspas simples:
-// tags 'dark hero' drama  -> ["dark hero", "drama"]
-static std::vector<std::string> parseTagsLine(const std::string& line) {
-    std::vector<std::string> result;
-    std::string current;
-    bool inQuotes = false;
-
-    for (char c : line) {
-        if (c == '\'') {
-            inQuotes = !inQuotes;
-            continue;
+// Linhas lidas e executadas de uma vez no --batch; limita a memória das saídas guardadas
+const std::size_t kBatchWindow = 4096;
+
+// --batch: lê os comandos em janelas, executa cada janela em paralelo sobre o DataContext
+// (só leitura) e escreve as saídas na ordem da entrada. Retorna o número de comandos.
+// O pool é criado uma vez e reaproveitado por todas as janelas.
+std::size_t runBatch(const DataContext& ctx, const commands::Options& options, unsigned threads) {
+    WorkStealingPool pool(threads);
+    std::vector<std::string> lines;
+    std::vector<std::string> outputs;
+    std::vector<std::string> errors;
+    std::size_t total = 0;
+
+    for (;;) {
+        lines.clear();
+        std::string line;
+        while (lines.size() < kBatchWindow && std::getline(std::cin, line)) {
+            lines.push_back(std::move(line));
         }
-
-        if (std::isspace(static_cast<unsigned char>(c)) && !inQuotes) {
-            if (!current.empty()) {
-                result.push_back(current);
-                current.clear();
-            }
-        } else {
-            current.push_back(c);
+        if (lines.empty()) break;
+
+        outputs.assign(lines.size(), std::string());
+        errors.assign(lines.size(), std::string());
+        pool.run(lines.size(), [&](std::size_t i) {
+            std::ostringstream out, err;
+            commands::execute(ctx, lines[i], options, out, err);
+            outputs[i] = out.str();
+            errors[i] = err.str();
+        });
+
+        for (std::size_t i = 0; i < lines.size(); ++i) {
+            std::cout << outputs[i];
+            if (!errors[i].empty()) std::cerr << errors[i];
         }
+        total += lines.size();
     }
+    return total;
+}
 
-    if (!current.empty()) {
-        result.push_back(current);
-    }
-
-    return result;
 }
 
 /* ------------------------------------------------------------------
    MAIN
 ------------------------------------------------------------------ */
 
-int main() {
-
-    DataContext ctx;
-
-    std::cerr << "Loading movies..." << std::endl;
-    data_loader::loadMovies("data/movies.csv", ctx);
-
-    std::cerr << "Loading ratings..." << std::endl;
-    data_loader::loadRatings("data/ratings.csv", ctx);
-
-    std::cerr << "Loading tags..." << std::endl;
-    data_loader::loadTags("data/tags.csv", ctx);
-
-    std::string line;
-
-    while (std::getline(std::cin, line)) {
-        if (line.empty()) continue;
-
-        std::istringstream iss(line);
-        std::string cmd;
-
-        if (!(iss >> cmd)) continue;
-
-        // ---------------- PREFIX ----------------
-        if (cmd == "prefix") {
-            std::string rest;
-            std::getline(iss, rest);
-            std::string prefix = trim(rest);
-
-            if (!prefix.empty()) {
-                queries::queryPrefix(ctx, prefix);
+int main(int argc, char** argv) {
+
+    // ---------------- OPÇÕES ----------------
+    // --threads N            : carrega o ratings.csv em paralelo com N threads
+    // --build-snapshot PATH    : depois de ler os CSVs, grava um snapshot binário em PATH
+    // --load-snapshot PATH     : carrega o snapshot de PATH; se estiver desatualizado ou
+    //                            inválido, volta a ler os CSVs
+    // --genre-match MODE       : "substring" (padrão) ou "exact" para o gênero da consulta top
+    // --neighbors K            : monta a tabela de vizinhos do recommend com K vizinhos por filme
+    //                            (usa as --threads); dispensável se o snapshot já tiver a tabela
+    // --output FORMAT          : "table" (padrão), "json" (um objeto por comando, em uma linha)
+    //                            ou "tsv" (cabeçalho com as chaves e uma linha por registro)
+    // --batch                  : lê todos os comandos do stdin e os executa em paralelo com as
+    //                            --threads, escrevendo as saídas na ordem da entrada
+    // --serve-unix PATH        : em vez do stdin, atende os comandos no socket Unix PATH
+    // --serve-tcp PORT         : idem em 127.0.0.1:PORT (pode ser junto com --serve-unix);
+    //                            os comandos rodam em --threads threads
+    unsigned threads = 1;
+    bool batch = false;
+    std::string serveUnixPath;
+    int serveTcpPort = -1;
+    std::size_t neighborCount = 0;
+    std::string buildSnapshotPath;
+    std::string loadSnapshotPath;
+    GenreMatch genreMatch = GenreMatch::Substring;
+    OutputFormat outputFormat = OutputFormat::Table;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--threads" && i + 1 < argc) {
+            try {
+                int n = std::stoi(argv[++i]);
+                threads = n > 0 ? static_cast<unsigned>(n) : 1;
+            }
+            catch (...) {
+                std::cerr << "Invalid thread count\n";
+                return 1;
             }
         }
-
-        // ---------------- USER ----------------
-        else if (cmd == "user") {
-            std::string userToken;
-
-            if (!(iss >> userToken)) continue;
-
+        else if (arg == "--batch") {
+            batch = true;
+        }
+        else if (arg == "--serve-unix" && i + 1 < argc) {
+            serveUnixPath = argv[++i];
+        }
+        else if (arg == "--serve-tcp" && i + 1 < argc) {
             try {
-                int userId = std::stoi(userToken);
-                queries::queryUser(ctx, userId);
+                serveTcpPort = std::stoi(argv[++i]);
             }
             catch (...) {
-                std::cerr << "Invalid user id\n";
+                serveTcpPort = -1;
+            }
+            if (serveTcpPort < 0 || serveTcpPort > 65535) {
+                std::cerr << "Invalid TCP port\n";
+                return 1;
             }
         }
-
-        // ---------------- TOP ----------------
-        else if (cmd == "top") {
-            std::string nToken;
-
-            if (!(iss >> nToken)) continue;
-
-            int n = 0;
+        else if (arg == "--build-snapshot" && i + 1 < argc) {
+            buildSnapshotPath = argv[++i];
+        }
+        else if (arg == "--load-snapshot" && i + 1 < argc) {
+            loadSnapshotPath = argv[++i];
+        }
+        else if (arg == "--neighbors" && i + 1 < argc) {
             try {
-                n = std::stoi(nToken);
+                int n = std::stoi(argv[++i]);
+                neighborCount = n > 0 ? static_cast<std::size_t>(n) : 0;
             }
             catch (...) {
-                continue;
+                std::cerr << "Invalid neighbor count\n";
+                return 1;
+            }
+        }
+        else if (arg == "--output" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format == "table") {
+                outputFormat = OutputFormat::Table;
+            } else if (format == "json") {
+                outputFormat = OutputFormat::Json;
+            } else if (format == "tsv") {
+                outputFormat = OutputFormat::Tsv;
+            } else {
+                std::cerr << "Invalid output format\n";
+                return 1;
+            }
+        }
+        else if (arg == "--genre-match" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "exact") {
+                genreMatch = GenreMatch::Exact;
+            } else if (mode == "substring") {
+                genreMatch = GenreMatch::Substring;
+            } else {
+                std::cerr << "Invalid genre match mode\n";
+                return 1;
             }
+        }
+        else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--threads N] [--build-snapshot PATH] [--load-snapshot PATH]"
+                      << " [--genre-match substring|exact] [--neighbors K] [--batch]"
+                      << " [--output table|json|tsv] [--serve-unix PATH] [--serve-tcp PORT]\n";
+            return 1;
+        }
+    }
 
-            std::string rest;
-            std::getline(iss, rest);
-            std::string genre = trim(rest);
+    bool serve = !serveUnixPath.empty() || serveTcpPort >= 0;
+    if (serve && batch) {
+        std::cerr << "--batch cannot be combined with --serve-unix/--serve-tcp\n";
+        return 1;
+    }
 
-            if (!genre.empty() && n > 0) {
-                queries::queryTop(ctx, n, genre);
-            }
+    DataContext ctx;
+
+    snapshot::Sources sources{"data/movies.csv", "data/ratings.csv", "data/tags.csv"};
+    bool fromSnapshot = false;
+
+    if (!loadSnapshotPath.empty()) {
+        std::cerr << "Loading snapshot..." << std::endl;
+        std::string error;
+        fromSnapshot = snapshot::load(loadSnapshotPath, ctx, sources, error);
+        if (!fromSnapshot) {
+            std::cerr << "  snapshot not used: " << error << ", falling back to CSV" << std::endl;
         }
+    }
 
-        // ---------------- TAGS ----------------
-        else if (cmd == "tags") {
+    if (!fromSnapshot) {
+        std::cerr << "Loading movies..." << std::endl;
+        data_loader::loadMovies(sources.movies, ctx);
 
-            std::string rest;
-            std::getline(iss, rest);
+        std::cerr << "Loading ratings..." << std::endl;
+        if (threads > 1) {
+            data_loader::RatingsLoadStats stats = data_loader::loadRatingsParallel(sources.ratings, ctx, threads);
+            std::cerr << "  " << stats.rows << " ratings with " << threads << " threads"
+                      << " (split " << stats.splitMs << " ms, parse " << stats.parseMs
+                      << " ms, merge " << stats.mergeMs << " ms)" << std::endl;
+        } else {
+            data_loader::loadRatings(sources.ratings, ctx);
+        }
 
-            auto tags = parseTagsLine(rest);
+        std::cerr << "Loading tags..." << std::endl;
+        data_loader::loadTags(sources.tags, ctx);
+    }
 
-            if (!tags.empty()) {
-                queries::queryTags(ctx, tags);
-            }
+    std::cerr << "Building indexes..." << std::endl;
+    data_loader::buildIndexes(ctx);
+
+    // A tabela do snapshot é reaproveitada se tiver o mesmo K
+    double neighborMs = -1.0;
+    if (neighborCount > 0 && ctx.neighbors.neighborsPerMovie() != neighborCount) {
+        std::cerr << "Building item neighbors..." << std::endl;
+        neighborMs = data_loader::buildNeighbors(ctx, neighborCount, threads);
+    }
+
+    if (!fromSnapshot && !buildSnapshotPath.empty()) {
+        std::cerr << "Writing snapshot..." << std::endl;
+        std::string error;
+        if (!snapshot::write(buildSnapshotPath, ctx, sources, error)) {
+            std::cerr << "  snapshot not written: " << error << std::endl;
         }
+    }
 
-        // ---------------- UNKNOWN ----------------
-        else {
-            std::cerr << "Unknown command\n";
+    std::size_t titles = ctx.trie.titleCount();
+    std::cerr << "  title trie: " << ctx.trie.nodeCount() << " nodes, "
+              << ctx.trie.memoryUsage() / 1024 << " KiB";
+    if (titles > 0) {
+        std::cerr << " (" << ctx.trie.memoryUsage() / titles << " bytes/title)";
+    }
+    std::cerr << std::endl;
+
+    std::cerr << "  title trigrams: " << ctx.titleIndex.trigramCount() << " trigrams, "
+              << ctx.titleIndex.memoryUsage() / 1024 << " KiB" << std::endl;
+
+    std::cerr << "  tag index: " << ctx.tags.listMemoryUsage() / 1024 << " KiB in movie lists, "
+              << ctx.tags.bitmapMemoryUsage() / 1024 << " KiB in bitmaps, "
+              << ctx.tags.textMemoryUsage() / 1024 << " KiB of text" << std::endl;
+
+    std::cerr << "  movie store: " << ctx.movies.size() << " movies, "
+              << ctx.movies.columnMemoryUsage() / 1024 << " KiB in columns, "
+              << ctx.movies.textMemoryUsage() / 1024 << " KiB of text, "
+              << ctx.movies.genreNames().size() << " genres" << std::endl;
+
+    std::cerr << "  user ratings: " << ctx.users.ratingCount() << " ratings of " << ctx.users.size()
+              << " users, " << ctx.users.memoryUsage() / 1024 << " KiB by user, "
+              << ctx.movieRatings.memoryUsage() / 1024 << " KiB by movie, "
+              << ctx.centered.memoryUsage() / 1024 << " KiB centered" << std::endl;
+
+    if (ctx.neighbors.neighborsPerMovie() > 0) {
+        std::cerr << "  item neighbors: " << ctx.neighbors.pairCount() << " pairs (up to "
+                  << ctx.neighbors.neighborsPerMovie() << " per movie), "
+                  << ctx.neighbors.memoryUsage() / 1024 << " KiB, ";
+        if (neighborMs < 0.0) {
+            std::cerr << "from snapshot" << std::endl;
+        } else {
+            std::cerr << "built in " << neighborMs << " ms with " << threads
+                      << (threads == 1 ? " thread" : " threads") << std::endl;
+        }
+    }
+
+    std::cerr << "  hash tables (entries/slots, max probe): movies " << ctx.movies.size()
+              << "/" << ctx.movies.capacity() << " " << ctx.movies.maxProbeLength()
+              << ", users " << ctx.users.size() << "/" << ctx.users.capacity() << " " << ctx.users.maxProbeLength()
+              << ", tags " << ctx.tags.size() << "/" << ctx.tags.capacity() << " " << ctx.tags.maxProbeLength()
+              << std::endl;
+
+    commands::Options options;
+    options.genreMatch = genreMatch;
+    options.format = outputFormat;
+
+    if (serve) {
+        server::Options serverOptions;
+        serverOptions.unixPath = serveUnixPath;
+        serverOptions.tcpPort = serveTcpPort;
+        serverOptions.threads = threads;
+        serverOptions.commands = options;
+        // O paralelismo fica entre os comandos dos clientes
+        serverOptions.commands.similarThreads = 1;
+
+        std::string error;
+        if (!server::run(ctx, serverOptions, error)) {
+            std::cerr << "  server not started: " << error << std::endl;
+            return 1;
         }
+        return 0;
+    }
+
+    if (batch) {
+        // O paralelismo fica entre as consultas
+        options.similarThreads = 1;
+        auto start = std::chrono::steady_clock::now();
+        std::size_t count = runBatch(ctx, options, threads);
+        auto end = std::chrono::steady_clock::now();
+        std::cerr << "  batch: " << count << " commands in "
+                  << std::chrono::duration<double, std::milli>(end - start).count() << " ms with "
+                  << threads << (threads == 1 ? " thread" : " threads") << std::endl;
+        return 0;
+    }
+
+    options.similarThreads = threads;
+    std::string line;
+
+    while (std::getline(std::cin, line)) {
+        commands::execute(ctx, line, options, std::cout, std::cerr);
     }
 
     return 0;
@@ -0,0 +1,64 @@
+#include "mapped_file.hpp"
+
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path)
+    : ptr(nullptr), length(0), opened(false), mapped(false), fallback() {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0) {
+        length = static_cast<std::size_t>(st.st_size);
+        opened = true;
+
+        if (length > 0) {
+            void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                // O arquivo é lido uma única vez do início ao fim
+                ::madvise(p, length, MADV_SEQUENTIAL);
+                ptr = static_cast<const char*>(p);
+                mapped = true;
+            }
+        }
+    }
+    ::close(fd);
+
+    if (opened && length > 0 && !mapped) {
+        // mmap falhou: lê o arquivo inteiro para memória
+        std::ifstream file(path, std::ios::binary);
+        fallback.resize(length);
+        if (!file.read(fallback.data(), static_cast<std::streamsize>(length))) {
+            fallback.clear();
+            length = 0;
+            opened = false;
+            return;
+        }
+        ptr = fallback.data();
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (mapped) {
+        ::munmap(const_cast<char*>(ptr), length);
+    }
+}
+
+bool MappedFile::isOpen() const {
+    return opened;
+}
+
+const char* MappedFile::data() const {
+    return ptr;
+}
+
+std::size_t MappedFile::size() const {
+    return length;
+}
@@ -0,0 +1,189 @@
+#include "metrics.hpp"
+
+#include <atomic>
+#include <cmath>
+
+namespace {
+
+const Column kLoadColumns[] = {
+    {"Phase", "phase", ColumnType::Text, 14},
+    {"ms", "ms", ColumnType::Real, 10, 1},
+    {"Rows", "rows", ColumnType::Integer, 10},
+};
+const TableSpec kLoadTable{"load", TableStyle::Grid, kLoadColumns, 3, 40};
+
+const Column kQueryColumns[] = {
+    {"Command", "command", ColumnType::Text, 10},
+    {"Count", "count", ColumnType::Integer, 8},
+    {"Mean us", "mean_us", ColumnType::Real, 10, 1},
+    {"p50 us", "p50_us", ColumnType::Real, 10, 1},
+    {"p90 us", "p90_us", ColumnType::Real, 10, 1},
+    {"p99 us", "p99_us", ColumnType::Real, 10, 1},
+    {"Max us", "max_us", ColumnType::Real, 10, 1},
+    {"Scanned", "rows_scanned", ColumnType::Integer, 12},
+    {"Sorted", "rows_sorted", ColumnType::Integer, 12},
+    {"Emitted", "rows_emitted", ColumnType::Integer, 10},
+};
+const TableSpec kQueryTable{"queries", TableStyle::Grid, kQueryColumns, 10, 132, true};
+
+const char* const kQueryNames[] = {
+    "prefix", "prefix -n", "contains", "fuzzy", "user", "movie", "recommend", "similar", "top", "tags",
+};
+const char* const kLoadNames[] = {
+    "loadMovies", "loadRatings", "loadTags", "buildIndexes", "buildNeighbors",
+};
+
+static_assert(sizeof(kQueryNames) / sizeof(kQueryNames[0]) == static_cast<std::size_t>(metrics::Query::Count),
+              "one name per query type");
+static_assert(sizeof(kLoadNames) / sizeof(kLoadNames[0]) == static_cast<std::size_t>(metrics::LoadPhase::Count),
+              "one name per load phase");
+
+} // namespace
+
+#if defined(NO_METRICS)
+
+namespace metrics {
+
+void report(ResultSink& sink) {
+    sink.message("Metrics disabled at compile time (NO_METRICS)");
+}
+
+} // namespace metrics
+
+#else
+
+namespace {
+
+// Valores 0..7 têm balde próprio; acima disso, 8 baldes por potência de 2
+const int kSubBits = 3;
+const std::size_t kSubBuckets = std::size_t(1) << kSubBits;
+const std::size_t kBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+std::size_t bucketOf(std::uint64_t value) {
+    if (value < kSubBuckets) return static_cast<std::size_t>(value);
+    int shift = 63 - __builtin_clzll(value) - kSubBits;
+    return (static_cast<std::size_t>(shift) + 1) * kSubBuckets + ((value >> shift) & (kSubBuckets - 1));
+}
+
+// Meio do intervalo de valores do balde
+double bucketValue(std::size_t bucket) {
+    if (bucket < kSubBuckets) return static_cast<double>(bucket);
+    int shift = static_cast<int>(bucket / kSubBuckets) - 1;
+    std::uint64_t low = static_cast<std::uint64_t>(kSubBuckets + bucket % kSubBuckets) << shift;
+    return static_cast<double>(low) + static_cast<double>((std::uint64_t(1) << shift) - 1) / 2.0;
+}
+
+// Histograma de latência (ns) e totais de um tipo de consulta. Fica em memória estática,
+// então os atômicos começam zerados.
+struct QueryStats {
+    std::atomic<std::uint64_t> buckets[kBuckets];
+    std::atomic<std::uint64_t> totalNanos;
+    std::atomic<std::uint64_t> maxNanos;
+    std::atomic<std::uint64_t> scanned;
+    std::atomic<std::uint64_t> sorted;
+    std::atomic<std::uint64_t> emitted;
+};
+
+QueryStats queryStats[static_cast<std::size_t>(metrics::Query::Count)];
+
+// A carga roda antes das consultas, em uma thread só
+struct LoadStats {
+    bool recorded;
+    std::uint64_t nanos;
+    std::size_t rows;
+};
+
+LoadStats loadStats[static_cast<std::size_t>(metrics::LoadPhase::Count)];
+
+void add(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+// Valor (ns) abaixo do qual ficam pelo menos p das amostras
+double percentile(const std::uint64_t* counts, std::uint64_t total, double p) {
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(p * static_cast<double>(total)));
+    if (rank == 0) rank = 1;
+    std::uint64_t seen = 0;
+    for (std::size_t b = 0; b < kBuckets; ++b) {
+        seen += counts[b];
+        if (seen >= rank) return bucketValue(b);
+    }
+    return 0.0;
+}
+
+} // namespace
+
+namespace metrics {
+
+namespace detail {
+
+thread_local Counters current;
+
+void recordQuery(Query query, std::uint64_t nanos, std::size_t emitted) {
+    QueryStats& stats = queryStats[static_cast<std::size_t>(query)];
+    add(stats.buckets[bucketOf(nanos)], 1);
+    add(stats.totalNanos, nanos);
+    add(stats.scanned, current.scanned);
+    add(stats.sorted, current.sorted);
+    add(stats.emitted, emitted);
+
+    std::uint64_t max = stats.maxNanos.load(std::memory_order_relaxed);
+    while (nanos > max && !stats.maxNanos.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+void recordLoad(LoadPhase phase, std::uint64_t nanos, std::size_t rows) {
+    LoadStats& stats = loadStats[static_cast<std::size_t>(phase)];
+    stats.recorded = true;
+    stats.nanos = nanos;
+    stats.rows = rows;
+}
+
+} // namespace detail
+
+void report(ResultSink& sink) {
+    sink.beginTable(kLoadTable);
+    for (std::size_t p = 0; p < static_cast<std::size_t>(LoadPhase::Count); ++p) {
+        const LoadStats& stats = loadStats[p];
+        if (!stats.recorded) continue;
+        sink.text(kLoadNames[p]);
+        sink.real(static_cast<double>(stats.nanos) / 1e6);
+        sink.integer(static_cast<long long>(stats.rows));
+        sink.endRow();
+    }
+    sink.endTable();
+
+    // Cópia dos baldes: as outras threads podem continuar contando durante o relatório
+    std::uint64_t counts[kBuckets];
+    sink.beginTable(kQueryTable);
+    for (std::size_t q = 0; q < static_cast<std::size_t>(Query::Count); ++q) {
+        const QueryStats& stats = queryStats[q];
+        std::uint64_t total = 0;
+        for (std::size_t b = 0; b < kBuckets; ++b) {
+            counts[b] = stats.buckets[b].load(std::memory_order_relaxed);
+            total += counts[b];
+        }
+        if (total == 0) continue;
+
+        double mean = static_cast<double>(stats.totalNanos.load(std::memory_order_relaxed)) /
+                      static_cast<double>(total);
+        sink.text(kQueryNames[q]);
+        sink.integer(static_cast<long long>(total));
+        sink.real(mean / 1e3);
+        // O meio do balde pode passar do máximo medido
+        double max = static_cast<double>(stats.maxNanos.load(std::memory_order_relaxed));
+        sink.real(std::fmin(percentile(counts, total, 0.50), max) / 1e3);
+        sink.real(std::fmin(percentile(counts, total, 0.90), max) / 1e3);
+        sink.real(std::fmin(percentile(counts, total, 0.99), max) / 1e3);
+        sink.real(max / 1e3);
+        sink.integer(static_cast<long long>(stats.scanned.load(std::memory_order_relaxed)));
+        sink.integer(static_cast<long long>(stats.sorted.load(std::memory_order_relaxed)));
+        sink.integer(static_cast<long long>(stats.emitted.load(std::memory_order_relaxed)));
+        sink.endRow();
+    }
+    sink.endTable();
+}
+
+} // namespace metrics
+
+#endif
@@ -1,104 +1,116 @@
 #include "movie.hpp"
 
+#include <cctype>
 #include <cstddef>
-#include <stdexcept>
 
-// Construtor que inicializa a tabela hash com a capacidade especificada
-MovieHashTable::MovieHashTable(std::size_t capacity) : table(), count(0) {
-    std::size_t cap = capacity == 0 ? 1 : capacity;
-    table.resize(cap);
-}
+namespace {
 
-// Calcula o índice inicial baseado na chave (movieId)
-std::size_t MovieHashTable::hash(int key) const {
-    return static_cast<std::size_t>(key) % table.size();
-}
+const std::size_t kMaxGenres = 64;
 
-// Realiza o cálculo do próximo índice em caso de colisão usando sondagem linear
-std::size_t MovieHashTable::probe(std::size_t index, std::size_t step) const {
-    return (index + step) % table.size();
+// Só dígitos depois da vírgula (ou nenhuma vírgula): uma busca por texto sem '|', ',' ou
+// dígitos só pode casar dentro do nome de um único gênero
+bool regularSuffix(std::string_view genres) {
+    std::size_t comma = genres.find(',');
+    if (comma == std::string_view::npos) return true;
+    for (std::size_t i = comma + 1; i < genres.size(); ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(genres[i]))) return false;
+    }
+    return true;
 }
 
-Movie& MovieHashTable::insertOrGet(int movieId) {
-    // índice base calculado a partir do movieId
-    std::size_t h = hash(movieId);
-
-    // sondagem linear
-    for (std::size_t step = 0; step < table.size(); ++step) {
-        std::size_t idx = probe(h, step);
-        MovieHashEntry& entry = table[idx];
-
-        if (entry.occupied) {
-            // Esse id já foi adicionado na tabela, retorna a referência ao Movie existente
-            if (!entry.deleted && entry.key == movieId) {
-                return entry.value;
-            }
-            // se for outro id ou marcado como deleted, continua sondando
-        } else {
-            // Slot vazio: insere aqui
-            entry.key              = movieId;
-            entry.value.movieId    = movieId;
-            entry.occupied         = true;
-            entry.deleted          = false;
-            ++count;
-            return entry.value;
-        }
-    }
+} // namespace
 
-    // Se chegou aqui, a tabela está cheia (situação anômala para o nosso contexto)
-    throw std::runtime_error("MovieHashTable::insertOrGet – Hash table full");
+MovieStore::MovieStore(std::size_t expected) : index(expected) {
+    reserve(expected);
 }
 
-// Percorre a tabela hash para encontrar o movieId especificado
-Movie* MovieHashTable::find(int movieId) {
-    std::size_t h = hash(movieId);
+void MovieStore::reserve(std::size_t n) {
+    index.reserve(n);
+    ids.reserve(n);
+    years.reserve(n);
+    ratingCounts.reserve(n);
+    ratingSums.reserve(n);
+    genreMasks.reserve(n);
+    irregular.reserve(n);
+    titles.reserve(n);
+    genreFields.reserve(n);
+}
 
-    for (std::size_t step = 0; step < table.size(); ++step) {
-        std::size_t idx = probe(h, step);
-        MovieHashEntry& entry = table[idx];
+int MovieStore::insertOrGet(int movieId) {
+    bool inserted = false;
+    int& slot = index.insertOrGet(movieId, inserted);
+    if (!inserted) return slot;
+
+    slot = static_cast<int>(ids.size());
+    ids.push_back(movieId);
+    years.push_back(0);
+    ratingCounts.push_back(0);
+    ratingSums.push_back(0.0);
+    genreMasks.push_back(0);
+    irregular.push_back(0);
+    titles.emplace_back();
+    genreFields.emplace_back();
+    return slot;
+}
 
-        if (!entry.occupied && !entry.deleted) {
-            // Slot nunca usado: podemos concluir que o elemento não existe
-            return nullptr;
-        }
+int MovieStore::indexOf(int movieId) const {
+    const int* slot = index.find(movieId);
+    return slot ? *slot : -1;
+}
 
-        if (entry.occupied && !entry.deleted && entry.key == movieId) {
-            return &entry.value;
-        }
-        // Continua procurando em caso de colisão ou entrada deletada
+int MovieStore::genreBit(std::string_view name) {
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) return static_cast<int>(i);
     }
-
-    return nullptr;
+    if (names.size() == kMaxGenres) return -1;
+    names.emplace_back(name);
+    return static_cast<int>(names.size()) - 1;
 }
 
-// Versão const de find
-const Movie* MovieHashTable::find(int movieId) const {
-    std::size_t h = hash(movieId);
+void MovieStore::setInfo(int idx, std::string_view title, std::string_view genres, int year) {
+    titles[idx] = text.append(title);
+    genreFields[idx] = text.intern(genres);
+    years[idx] = year;
 
-    for (std::size_t step = 0; step < table.size(); ++step) {
-        std::size_t idx = probe(h, step);
-        const MovieHashEntry& entry = table[idx];
+    // Máscara de gêneros: os nomes ficam antes da vírgula, separados por '|'
+    std::uint64_t mask = 0;
+    bool odd = !regularSuffix(genres);
 
-        if (!entry.occupied && !entry.deleted) {
-            // Slot nunca usado: elemento não existe
-            return nullptr;
-        }
+    std::string_view list = genres.substr(0, genres.find(','));
+    std::size_t start = 0;
+    while (start <= list.size()) {
+        std::size_t bar = list.find('|', start);
+        if (bar == std::string_view::npos) bar = list.size();
 
-        if (entry.occupied && !entry.deleted && entry.key == movieId) {
-            return &entry.value;
+        int bit = genreBit(list.substr(start, bar - start));
+        if (bit == -1) {
+            odd = true;
+        } else {
+            mask |= std::uint64_t(1) << bit;
         }
-        // Continua procurando em caso de colisão ou entrada deletada
+        start = bar + 1;
     }
 
-    return nullptr;
+    genreMasks[idx] = mask;
+    irregular[idx] = odd ? 1 : 0;
+}
+
+std::size_t MovieStore::capacity() const {
+    return index.capacity();
+}
+
+std::size_t MovieStore::maxProbeLength() const {
+    return index.maxProbeLength();
 }
 
-// Retorna referência ao array da tabela hash
-std::vector<MovieHashEntry>& MovieHashTable::rawTable() {
-    return table;
+std::size_t MovieStore::columnMemoryUsage() const {
+    return ids.capacity() * sizeof(int) + years.capacity() * sizeof(int) +
+           ratingCounts.capacity() * sizeof(int) + ratingSums.capacity() * sizeof(double) +
+           genreMasks.capacity() * sizeof(std::uint64_t) + irregular.capacity() +
+           (titles.capacity() + genreFields.capacity()) * sizeof(StringRef) +
+           index.capacity() * (1 + 2 * sizeof(int));
 }
 
-// Retorna referência constante ao array da tabela hash
-const std::vector<MovieHashEntry>& MovieHashTable::rawTable() const {
-    return table;
+std::size_t MovieStore::textMemoryUsage() const {
+    return text.memoryUsage();
 }
@@ -0,0 +1,59 @@
+#include "movie_ratings.hpp"
+
+void MovieRatings::build(const UserStore& store, std::size_t movieCount) {
+    const std::vector<std::uint64_t>& userOffsets = store.offsetColumn();
+    const std::vector<std::int32_t>& userMovies = store.movieColumn();
+    bool halfStars = store.exactColumn().empty();
+    std::size_t total = userMovies.size();
+
+    // Contagem por filme e soma de prefixos
+    offsets.assign(movieCount + 1, 0);
+    for (std::int32_t m : userMovies) {
+        ++offsets[m + 1];
+    }
+    for (std::size_t m = 0; m < movieCount; ++m) {
+        offsets[m + 1] += offsets[m];
+    }
+
+    users.assign(total, 0);
+    codes.clear();
+    exact.clear();
+    if (halfStars) {
+        codes.assign(total, 0);
+    } else {
+        exact.assign(total, 0.0f);
+    }
+
+    // Os usuários são percorridos em ordem, então cada filme recebe seus avaliadores já ordenados
+    std::vector<std::uint64_t> next(offsets.begin(), offsets.end() - 1);
+    std::size_t userCount = store.size();
+    for (std::size_t u = 0; u < userCount; ++u) {
+        for (std::uint64_t r = userOffsets[u]; r < userOffsets[u + 1]; ++r) {
+            std::uint64_t pos = next[userMovies[r]]++;
+            users[pos] = static_cast<std::int32_t>(u);
+            if (halfStars) {
+                codes[pos] = store.codeColumn()[r];
+            } else {
+                exact[pos] = store.exactColumn()[r];
+            }
+        }
+    }
+}
+
+RaterSpan MovieRatings::raters(int movie) const {
+    RaterSpan span;
+    std::uint64_t begin = offsets[movie];
+    span.size = static_cast<std::size_t>(offsets[movie + 1] - begin);
+    span.users = users.data() + begin;
+    if (exact.empty()) {
+        span.codes = codes.data() + begin;
+    } else {
+        span.exact = exact.data() + begin;
+    }
+    return span;
+}
+
+std::size_t MovieRatings::memoryUsage() const {
+    return offsets.capacity() * sizeof(std::uint64_t) + users.capacity() * sizeof(std::int32_t) +
+           codes.capacity() + exact.capacity() * sizeof(float);
+}
@@ -1,11 +1,14 @@
 #include "queries.hpp"
+#include "intersect.hpp"
+#include "metrics.hpp"
+#include "similarity.hpp"
 #include "sort_utils.hpp"
 
-#include <iostream>
-#include <iomanip>
 #include <algorithm>
 #include <cctype>
+#include <cmath>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace {
@@ -48,406 +51,814 @@ namespace {
         return tag;
     }
 
-    std::string extractGenres(const std::string& s) {
+    std::string_view extractGenres(std::string_view s) {
         auto pos = s.find(',');
-        if (pos == std::string::npos) return s;
+        if (pos == std::string_view::npos) return s;
         return s.substr(0, pos);
     }
 
-    std::string extractYear(const std::string& s) {
+    std::string_view extractYear(std::string_view s) {
         auto pos = s.find(',');
-        if (pos == std::string::npos) return "";
+        if (pos == std::string_view::npos) return std::string_view();
         return s.substr(pos + 1);
     }
 
+    // Colunas ID | Title | Genres | Year, comuns a todas as tabelas de filmes
+    const Column kIdColumn{"ID", "id", ColumnType::Integer, 6};
+    const Column kTitleColumn{"Title", "title", ColumnType::Text, 40, 6, 40};
+    const Column kGenresColumn{"Genres", "genres", ColumnType::Text, 25, 6, 25};
+    const Column kYearColumn{"Year", "year", ColumnType::IntegerText, 6};
+    const Column kAvgColumn{"AvgRate", "avg_rating", ColumnType::Real, 10};
+
+    // Tabela de filmes usada por prefix e tags
+    const Column kMovieColumns[] = {
+        kIdColumn, kTitleColumn, kGenresColumn, kYearColumn, kAvgColumn,
+        {"count", "rating_count", ColumnType::Integer, 8},
+    };
+    const TableSpec kMovieTable{"rows", TableStyle::Grid, kMovieColumns, 6, 105};
+
+    // Tabela de filmes com a distância de edição, usada por fuzzy
+    const Column kFuzzyColumns[] = {
+        kIdColumn, kTitleColumn, kGenresColumn, kYearColumn, kAvgColumn,
+        {"count", "rating_count", ColumnType::Integer, 8},
+        {"Edits", "edits", ColumnType::Integer, 6},
+    };
+    const TableSpec kFuzzyTable{"rows", TableStyle::Grid, kFuzzyColumns, 7, 112};
+
+    const Column kUserColumns[] = {
+        kIdColumn, kTitleColumn, kGenresColumn, kYearColumn,
+        {"UserRate", "user_rating", ColumnType::Real, 10},
+        {"GlobalAvg", "avg_rating", ColumnType::Real, 10},
+        {"count", "rating_count", ColumnType::Integer, 8},
+    };
+    const TableSpec kUserTable{"rows", TableStyle::Grid, kUserColumns, 7, 110};
+
+    // Consulta movie: cabeçalho do filme, resumo das notas, histograma e maiores notas
+    const Column kMovieInfoColumns[] = {
+        {"Movie ", "id", ColumnType::Integer},
+        {"", "title", ColumnType::Text},
+        {"", "genres", ColumnType::Text},
+        {"", "year", ColumnType::IntegerText},
+    };
+    const TableSpec kMovieInfoTable{"movie", TableStyle::Labeled, kMovieInfoColumns, 4};
+
+    const Column kRatingSummaryColumns[] = {
+        {"Ratings: ", "count", ColumnType::Integer},
+        {"Avg: ", "avg", ColumnType::Real},
+        {"Median: ", "median", ColumnType::Real},
+        {"Stddev: ", "stddev", ColumnType::Real},
+    };
+    const TableSpec kRatingSummaryTable{"ratings", TableStyle::Labeled, kRatingSummaryColumns, 4};
+    // Filme sem avaliações: só a contagem
+    const TableSpec kNoRatingsTable{"ratings", TableStyle::Labeled, kRatingSummaryColumns, 1};
+
+    const Column kHistogramColumns[] = {
+        {"Rating", "rating", ColumnType::Real, 6, 1},
+        {"count", "count", ColumnType::Integer, 8},
+        {"Histogram", "bar", ColumnType::Text, 0, 6, 0, true},
+    };
+    const TableSpec kHistogramTable{"histogram", TableStyle::Grid, kHistogramColumns, 3, 60};
+
+    const Column kRaterColumns[] = {
+        {"UserId", "user_id", ColumnType::Integer, 8},
+        {"Rating", "rating", ColumnType::Real, 10},
+        {"UserRatings", "user_ratings", ColumnType::Integer, 11},
+    };
+    const TableSpec kRaterTable{"top_raters", TableStyle::Grid, kRaterColumns, 3, 35, true};
+
+    const Column kRecommendColumns[] = {
+        kIdColumn, kTitleColumn, kGenresColumn, kYearColumn,
+        {"Predicted", "predicted_rating", ColumnType::Real, 10},
+        {"GlobalAvg", "avg_rating", ColumnType::Real, 10},
+        {"count", "rating_count", ColumnType::Integer, 8},
+    };
+    const TableSpec kRecommendTable{"rows", TableStyle::Grid, kRecommendColumns, 7, 110};
+
+    const Column kSimilarColumns[] = {
+        kIdColumn, kTitleColumn, kGenresColumn, kYearColumn,
+        {"Similarity", "similarity", ColumnType::Real, 10},
+        {"Common", "common_raters", ColumnType::Integer, 6},
+        kAvgColumn,
+        {"count", "rating_count", ColumnType::Integer, 8},
+    };
+    const TableSpec kSimilarTable{"rows", TableStyle::Grid, kSimilarColumns, 8, 119};
+
+    const Column kTopColumns[] = {
+        kIdColumn, kTitleColumn, kGenresColumn, kYearColumn, kAvgColumn,
+        {"Ratings", "rating_count", ColumnType::Integer, 8},
+    };
+    const TableSpec kTopTable{"rows", TableStyle::Grid, kTopColumns, 6, 110};
+
+    // Barra do histograma: um trecho deste texto
+    const char kBar[] = "########################################";
+
+    // Células ID, Title, Genres e Year de um filme
+    void movieCells(ResultSink& sink, int movieId, std::string_view title, std::string_view genresField) {
+        sink.integer(movieId);
+        sink.text(title);
+        sink.text(extractGenres(genresField));
+        sink.text(extractYear(genresField));
+    }
+
+    void movieRow(ResultSink& sink, int movieId, std::string_view title, std::string_view genresField, double avg, int ratingCount) {
+        movieCells(sink, movieId, title, genresField);
+        sink.real(avg);
+        sink.integer(ratingCount);
+        sink.endRow();
+    }
+
+    // Imprime os filmes de ids (os que têm avaliações), ordenados por média global desc,
+    // depois ratingCount desc, depois movieId asc. Usado pelas consultas de tags.
+    void printTagResults(const DataContext& ctx, ResultSink& sink, const std::vector<int>& ids) {
+        // Título e gêneros só são lidos do catálogo na impressão
+        struct TagResult {
+            int movieId;
+            int movie;
+            double avg;
+            int ratingCount;
+        };
+
+        const MovieStore& movies = ctx.movies;
+        std::vector<TagResult> results;
+        results.reserve(ids.size());
+
+        for (int id : ids) {
+            int idx = movies.indexOf(id);
+            if (idx < 0) continue;
+            if (movies.ratingCount(idx) <= 0) continue;
+
+            results.push_back(TagResult{
+                id,
+                idx,
+                movies.average(idx),
+                movies.ratingCount(idx)
+            });
+        }
+
+        // Ordena por média global desc, depois ratingCount desc, depois movieId asc
+        metrics::addSorted(results.size());
+        sort_utils::quickSort(results, [](const TagResult& a, const TagResult& b) {
+            if (a.avg != b.avg) return a.avg > b.avg;
+            if (a.ratingCount != b.ratingCount) return a.ratingCount > b.ratingCount;
+            return a.movieId < b.movieId;
+        });
+
+        sink.beginTable(kMovieTable);
+        for (const auto& r : results) {
+            movieRow(sink, r.movieId, movies.title(r.movie), movies.genres(r.movie), r.avg, r.ratingCount);
+        }
+        sink.endTable();
+    }
+
+    // "|" separa alternativas (OR) e "-tag" exclui a tag (NOT); termos entre aspas são tags
+    bool isTagOr(const queries::TagToken& token) {
+        return !token.quoted && token.text == "|";
+    }
+
+    bool isTagNot(const queries::TagToken& token) {
+        return !token.quoted && token.text.size() > 1 && token.text[0] == '-';
+    }
+
+    bool isTagOperator(const queries::TagToken& token) {
+        return isTagOr(token) || isTagNot(token);
+    }
+
+    // Avalia uma expressão de tags sobre os bitmaps. Tags lado a lado são combinadas
+    // com AND, "-tag" remove os filmes da tag e "|" separa alternativas, com AND
+    // tendo precedência: "a -b | c" = (a AND NOT b) OR c. Uma alternativa só com
+    // negações parte de todos os filmes.
+    void queryTagExpression(const DataContext& ctx, ResultSink& sink, const std::vector<queries::TagToken>& tokens) {
+        RoaringBitmap result;
+        std::size_t pos = 0;
+
+        while (pos <= tokens.size()) {
+            // Alternativa atual: tokens até o próximo "|"
+            std::size_t end = pos;
+            while (end < tokens.size() && !isTagOr(tokens[end])) ++end;
+
+            RoaringBitmap term;
+            bool hasPositive = false;
+            bool hasTokens = false;
+
+            for (std::size_t i = pos; i < end; ++i) {
+                if (isTagNot(tokens[i])) continue;
+                RoaringBitmap tagBits = ctx.tags.bitmapOf(normalizeTag(tokens[i].text), ctx.denseMovieIds);
+                term = hasPositive ? term.andWith(tagBits) : tagBits;
+                hasPositive = true;
+                hasTokens = true;
+            }
+
+            for (std::size_t i = pos; i < end; ++i) {
+                if (!isTagNot(tokens[i])) continue;
+                if (!hasPositive) {
+                    term = RoaringBitmap::range(static_cast<std::uint32_t>(ctx.denseMovieIds.size()));
+                    hasPositive = true;
+                }
+                term = term.andNot(ctx.tags.bitmapOf(normalizeTag(tokens[i].text.substr(1)), ctx.denseMovieIds));
+                hasTokens = true;
+            }
+
+            if (hasTokens) {
+                result = result.orWith(term);
+            }
+            pos = end + 1;
+        }
+
+        std::vector<std::uint32_t> dense;
+        result.toVector(dense);
+        metrics::addScanned(dense.size());
+
+        std::vector<int> ids;
+        ids.reserve(dense.size());
+        for (std::uint32_t d : dense) {
+            ids.push_back(ctx.denseMovieIds[d]);
+        }
+
+        printTagResults(ctx, sink, ids);
+    }
 
 } // namespace
 
 
 namespace queries {
 
-void queryPrefix(DataContext& ctx, const std::string& prefix) {
+void queryPrefix(const DataContext& ctx, ResultSink& sink, const std::string& prefix) {
     struct PrefixResult {
         int movieId;
-        std::string title;
-        std::string genres;
+        int movie;
         double avg;
         int ratingCount;
     };
 
+    const MovieStore& movies = ctx.movies;
     auto ids = ctx.trie.searchPrefix(prefix);
+    metrics::addScanned(ids.size());
     std::vector<PrefixResult> results;
     results.reserve(ids.size());
 
     for (int id : ids) {
-        Movie* m = ctx.movies.find(id);
-        if (!m) continue;
-        if (m->ratingCount <= 0) continue;
+        int idx = movies.indexOf(id);
+        if (idx < 0) continue;
+        if (movies.ratingCount(idx) <= 0) continue;
 
-        double avg = m->ratingSum / static_cast<double>(m->ratingCount);
         results.push_back(PrefixResult{
-            m->movieId,
-            m->title,
-            m->genres,
-            avg,
-            m->ratingCount
+            id,
+            idx,
+            movies.average(idx),
+            movies.ratingCount(idx)
         });
     }
 
-    if (results.empty()) {
-        return;
-    }
-
     //Os resultados com a maior média de avaliação aparecerão primeiro na lista.
     // Em caso de empate na média, o filme com maior número de avaliações aparecerá primeiro.
     // Se ainda houver empate, o filme com o menor movieId aparecerá primeiro.
+    metrics::addSorted(results.size());
     sort_utils::quickSort(results, [](const PrefixResult& a, const PrefixResult& b) {
         if (a.avg != b.avg) return a.avg > b.avg;
         if (a.ratingCount != b.ratingCount) return a.ratingCount > b.ratingCount;
         return a.movieId < b.movieId;
     });
 
-    std::cout << std::fixed << std::setprecision(6);
+    sink.beginTable(kMovieTable);
+    for (const auto& r : results) {
+        movieRow(sink, r.movieId, movies.title(r.movie), movies.genres(r.movie), r.avg, r.ratingCount);
+    }
+    sink.endTable();
+}
 
-    if (results.empty()) {
+// Versão "prefix -n N <texto>": usa os melhores filmes pré-calculados nos nós da TRIE,
+// então não precisa coletar e ordenar todos os títulos com o prefixo
+void queryPrefixTop(const DataContext& ctx, ResultSink& sink, const std::string& prefix, int n) {
+    if (n <= 0) {
         return;
     }
 
-    std::cout
-        << std::setw(6)  << "ID"
-        << " | " << std::setw(40) << "Title"
-        << " | " << std::setw(25) << "Genres"
-        << " | " << std::setw(6)  << "Year"
-        << " | " << std::setw(10) << "AvgRate"
-        << " | " << std::setw(8)  << "count"
-        << '\n';
+    auto ids = ctx.trie.topByPrefix(prefix, static_cast<std::size_t>(n));
+    metrics::addScanned(ids.size());
 
-    std::cout << std::string(105, '-') << '\n';
+    sink.beginTable(kMovieTable);
+    const MovieStore& movies = ctx.movies;
+    for (int id : ids) {
+        int idx = movies.indexOf(id);
+        if (idx < 0) continue;
 
+        movieRow(sink, id, movies.title(idx), movies.genres(idx), movies.average(idx), movies.ratingCount(idx));
+    }
+    sink.endTable();
+}
+
+// Títulos que contêm o texto em qualquer posição (via TrigramIndex), na ordem do prefix
+void queryContains(const DataContext& ctx, ResultSink& sink, const std::string& text) {
+    struct ContainsResult {
+        int movieId;
+        int movie;
+        double avg;
+        int ratingCount;
+    };
 
+    const MovieStore& movies = ctx.movies;
+    std::size_t candidates = 0;
+    std::vector<int> found = ctx.titleIndex.search(movies, text, candidates);
+    metrics::addScanned(candidates);
+    std::vector<ContainsResult> results;
+    results.reserve(found.size());
+
+    for (int idx : found) {
+        if (movies.ratingCount(idx) <= 0) continue;
+
+        results.push_back(ContainsResult{
+            movies.movieIds()[idx],
+            idx,
+            movies.average(idx),
+            movies.ratingCount(idx)
+        });
+    }
+
+    metrics::addSorted(results.size());
+    sort_utils::quickSort(results, [](const ContainsResult& a, const ContainsResult& b) {
+        if (a.avg != b.avg) return a.avg > b.avg;
+        if (a.ratingCount != b.ratingCount) return a.ratingCount > b.ratingCount;
+        return a.movieId < b.movieId;
+    });
+
+    sink.beginTable(kMovieTable);
     for (const auto& r : results) {
-        std::string genres = extractGenres(r.genres);
-        std::string year   = extractYear(r.genres);
+        movieRow(sink, r.movieId, movies.title(r.movie), movies.genres(r.movie), r.avg, r.ratingCount);
+    }
+    sink.endTable();
+}
+
+// Busca tolerante a erros de digitação: títulos com um prefixo a até maxEdits edições do
+// texto, do mais próximo para o mais distante e, com a mesma distância, na ordem do prefix
+void queryFuzzy(const DataContext& ctx, ResultSink& sink, const std::string& text, int maxEdits) {
+    struct FuzzyResult {
+        int movieId;
+        int movie;
+        int distance;
+        double avg;
+        int ratingCount;
+    };
 
-        std::cout
-            << std::setw(6)  << r.movieId
-            << " | " << std::setw(40) << r.title.substr(0,40)
-            << " | " << std::setw(25) << genres.substr(0,25)
-            << " | " << std::setw(6)  << year
-            << " | " << std::setw(10) << r.avg
-            << " | " << std::setw(8)  << r.ratingCount
-            << '\n';
+    const MovieStore& movies = ctx.movies;
+    std::vector<FuzzyMatch> matches = ctx.trie.searchFuzzy(text, maxEdits);
+    metrics::addScanned(matches.size());
+    std::vector<FuzzyResult> results;
+    results.reserve(matches.size());
+
+    for (const FuzzyMatch& match : matches) {
+        int idx = movies.indexOf(match.movieId);
+        if (idx < 0) continue;
+        if (movies.ratingCount(idx) <= 0) continue;
+
+        results.push_back(FuzzyResult{
+            match.movieId,
+            idx,
+            match.distance,
+            movies.average(idx),
+            movies.ratingCount(idx)
+        });
     }
 
+    metrics::addSorted(results.size());
+    sort_utils::quickSort(results, [](const FuzzyResult& a, const FuzzyResult& b) {
+        if (a.distance != b.distance) return a.distance < b.distance;
+        if (a.avg != b.avg) return a.avg > b.avg;
+        if (a.ratingCount != b.ratingCount) return a.ratingCount > b.ratingCount;
+        return a.movieId < b.movieId;
+    });
 
+    sink.beginTable(kFuzzyTable);
+    for (const auto& r : results) {
+        movieCells(sink, r.movieId, movies.title(r.movie), movies.genres(r.movie));
+        sink.real(r.avg);
+        sink.integer(r.ratingCount);
+        sink.integer(r.distance);
+        sink.endRow();
+    }
+    sink.endTable();
 }
 
-void queryUser(DataContext& ctx, int userId) {
+void queryUser(const DataContext& ctx, ResultSink& sink, int userId) {
+    // Título e gêneros são lidos do catálogo só para as linhas impressas
     struct UserResult {
         int movieId;
-        std::string title;
-        std::string genres;
+        int movie;
         float userRating;
         double globalAvg;
         int ratingCount;
     };
 
 
-    User* user = ctx.users.find(userId);
-    if (!user) {
-        std::cout << "User not found\n";
+    int user = ctx.users.indexOf(userId);
+    if (user < 0) {
+        sink.message("User not found");
         return;
     }
 
+    // As avaliações do usuário são um trecho contíguo do CSR
+    RatingSpan ratings = ctx.users.ratings(user);
+    const MovieStore& movies = ctx.movies;
+
     std::vector<UserResult> results;
-    results.reserve(user->ratings.size());
+    results.reserve(ratings.size);
+    metrics::addScanned(ratings.size);
 
-    for (const auto& ur : user->ratings) {
-        Movie* m = ctx.movies.find(ur.movieId);
-        if (!m) continue;
-        if (m->ratingCount <= 0) continue;
+    for (std::size_t i = 0; i < ratings.size; ++i) {
+        int idx = ratings.movies[i];
+        if (movies.ratingCount(idx) <= 0) continue;
 
-        double avg = m->ratingSum / static_cast<double>(m->ratingCount);
         results.push_back(UserResult{
-            m->movieId,
-            m->title,
-            m->genres,
-            ur.rating,
-            avg,
-            m->ratingCount
+            movies.movieId(idx),
+            idx,
+            ratings.rating(i),
+            movies.average(idx),
+            movies.ratingCount(idx)
         });
 
     }
 
-    if (results.empty()) {
-        return;
-    }
-
     // O fator mais importante é a nota que o usuário deu ao item. Resultados com a classificação mais alta do próprio usuário são priorizados
     // Em caso de empate, a média global do filme é usada como critério de desempate, com médias mais altas tendo prioridade.
     // Se ainda houver empate, o filme com o menor movieId aparecerá primeiro.
-    sort_utils::quickSort(results, [](const UserResult& a, const UserResult& b) {
+    // Só as 20 primeiras são impressas, então basta uma seleção parcial.
+    metrics::addSorted(results.size());
+    sort_utils::selectTop(results, 20, [](const UserResult& a, const UserResult& b) {
         if (a.userRating != b.userRating) return a.userRating > b.userRating;
         if (a.globalAvg != b.globalAvg) return a.globalAvg > b.globalAvg;
         return a.movieId < b.movieId;
     });
 
-    std::cout << std::fixed << std::setprecision(6);
-
     int limit = static_cast<int>(results.size());
-    if (limit > 20) limit = 20;
 
-    if (limit == 0) {
+    sink.beginTable(kUserTable);
+    for (int i = 0; i < limit; ++i) {
+        const auto& r = results[i];
+
+        movieCells(sink, r.movieId, movies.title(r.movie), movies.genres(r.movie));
+        sink.real(r.userRating);
+        sink.real(r.globalAvg);
+        sink.integer(r.ratingCount);
+        sink.endRow();
+    }
+    sink.endTable();
+}
+
+// Distribuição das notas de um filme: histograma por meia estrela, mediana, desvio padrão
+// e os usuários que deram as maiores notas. Só lê o trecho do filme no CSR por filme.
+void queryMovie(const DataContext& ctx, ResultSink& sink, int movieId) {
+    const MovieStore& movies = ctx.movies;
+    int idx = movies.indexOf(movieId);
+    if (idx < 0) {
+        sink.message("Movie not found");
         return;
     }
 
-    // Cabeçalho específico de USER
-    std::cout
-        << std::setw(6)  << "ID"
-        << " | " << std::setw(40) << "Title"
-        << " | " << std::setw(25) << "Genres"
-        << " | " << std::setw(6)  << "Year"
-        << " | " << std::setw(10) << "UserRate"
-        << " | " << std::setw(10) << "GlobalAvg"
-        << " | " << std::setw(8)  << "count"
-        << '\n';
+    RaterSpan raters = ctx.movieRatings.raters(idx);
+    metrics::addScanned(raters.size);
 
-    std::cout << std::string(110, '-') << '\n';
+    sink.beginTable(kMovieInfoTable);
+    movieCells(sink, movieId, movies.title(idx), movies.genres(idx));
+    sink.endRow();
+    sink.endTable();
 
-    for (int i = 0; i < limit; ++i) {
-        const auto& r = results[i];
-        std::string genres = extractGenres(r.genres);
-        std::string year   = extractYear(r.genres);
+    if (raters.size == 0) {
+        sink.beginTable(kNoRatingsTable);
+        sink.integer(0);
+        sink.endRow();
+        sink.endTable();
+        return;
+    }
 
-        std::cout
-            << std::setw(6)  << r.movieId
-            << " | " << std::setw(40) << r.title.substr(0,40)
-            << " | " << std::setw(25) << genres.substr(0,25)
-            << " | " << std::setw(6)  << year
-            << " | " << std::setw(10) << r.userRating
-            << " | " << std::setw(10) << r.globalAvg
-            << " | " << std::setw(8)  << r.ratingCount
-            << '\n';
+    // Histograma por meia estrela (nota * 2; notas fora do padrão caem na meia estrela abaixo)
+    // e média para o desvio padrão
+    std::vector<std::size_t> bins(256, 0);
+    double mean = 0.0;
+    for (std::size_t i = 0; i < raters.size; ++i) {
+        double r = raters.rating(i);
+        double twice = std::floor(r * 2.0);
+        if (twice < 0.0) twice = 0.0;
+        if (twice > 255.0) twice = 255.0;
+        ++bins[static_cast<std::size_t>(twice)];
+        mean += r;
     }
+    mean /= static_cast<double>(raters.size);
 
+    double squares = 0.0;
+    for (std::size_t i = 0; i < raters.size; ++i) {
+        double d = raters.rating(i) - mean;
+        squares += d * d;
+    }
+    double stddev = std::sqrt(squares / static_cast<double>(raters.size));
+
+    // Mediana: com códigos de meia estrela sai direto do histograma; com notas em float,
+    // de uma cópia ordenada
+    std::size_t lower = (raters.size - 1) / 2;
+    std::size_t upper = raters.size / 2;
+    double median = 0.0;
+    if (raters.exact == nullptr) {
+        std::size_t seen = 0;
+        double lowValue = 0.0;
+        for (std::size_t b = 0; b < bins.size(); ++b) {
+            if (bins[b] == 0) continue;
+            if (seen <= lower && lower < seen + bins[b]) lowValue = b * 0.5;
+            if (seen <= upper && upper < seen + bins[b]) {
+                median = (lowValue + b * 0.5) / 2.0;
+                break;
+            }
+            seen += bins[b];
+        }
+    } else {
+        std::vector<float> values(raters.exact, raters.exact + raters.size);
+        metrics::addSorted(values.size());
+        sort_utils::quickSort(values, [](float a, float b) { return a < b; });
+        median = (static_cast<double>(values[lower]) + values[upper]) / 2.0;
+    }
 
-}
+    sink.beginTable(kRatingSummaryTable);
+    sink.integer(static_cast<long long>(raters.size));
+    sink.real(movies.average(idx));
+    sink.real(median);
+    sink.real(stddev);
+    sink.endRow();
+    sink.endTable();
+
+    // Histograma do menor ao maior valor presente
+    std::size_t first = 0;
+    while (bins[first] == 0) ++first;
+    std::size_t last = bins.size() - 1;
+    while (bins[last] == 0) --last;
+
+    std::size_t peak = 0;
+    for (std::size_t b = first; b <= last; ++b) {
+        if (bins[b] > peak) peak = bins[b];
+    }
 
-void queryTop(DataContext& ctx, int n, const std::string& genre) {
-    struct TopResult {
-        int movieId;
-        std::string title;
-        std::string genres;
-        double avg;
-        int ratingCount;
+    sink.beginTable(kHistogramTable);
+    for (std::size_t b = first; b <= last; ++b) {
+        std::size_t bar = (bins[b] * 40 + peak - 1) / peak;
+        sink.real(b * 0.5);
+        sink.integer(static_cast<long long>(bins[b]));
+        sink.text(std::string_view(kBar, bar));
+        sink.endRow();
+    }
+    sink.endTable();
+
+    // Maiores notas; no empate vem quem avaliou mais filmes, depois o menor userId
+    struct Rater {
+        int userId;
+        float rating;
+        std::size_t userRatings;
     };
 
-    const auto& table = ctx.movies.rawTable();
-    std::vector<TopResult> results;
-    results.reserve(table.size());
+    std::vector<Rater> top;
+    top.reserve(raters.size);
+    for (std::size_t i = 0; i < raters.size; ++i) {
+        int user = raters.users[i];
+        top.push_back(Rater{ctx.users.userId(user), raters.rating(i), ctx.users.ratings(user).size});
+    }
+
+    metrics::addSorted(top.size());
+    sort_utils::selectTop(top, 10, [](const Rater& a, const Rater& b) {
+        if (a.rating != b.rating) return a.rating > b.rating;
+        if (a.userRatings != b.userRatings) return a.userRatings > b.userRatings;
+        return a.userId < b.userId;
+    });
 
-    // Varre todos os filmes na hash
-    for (const auto& entry : table) {
-        if (!entry.occupied || entry.deleted) continue;
+    sink.beginTable(kRaterTable);
+    for (const Rater& r : top) {
+        sink.integer(r.userId);
+        sink.real(r.rating);
+        sink.integer(static_cast<long long>(r.userRatings));
+        sink.endRow();
+    }
+    sink.endTable();
+}
 
-        const Movie& m = entry.value;
+// Filmes que o usuário ainda não avaliou, pela nota prevista com os vizinhos item-item:
+// para cada filme j candidato, média do usuário + soma(sim(i, j) * desvio da nota de i) /
+// soma(sim(i, j)), sobre os filmes i avaliados pelo usuário que têm j entre seus vizinhos.
+void queryRecommend(const DataContext& ctx, ResultSink& sink, int userId, int n) {
+    // Candidatos precisam vir de pelo menos este número de filmes avaliados
+    const int kMinSupport = 2;
 
-        // Requisitos do enunciado
-        if (m.ratingCount < 1000) continue;
-        if (m.ratingCount <= 0) continue;
-        // Filtra por gênero, se fornecido, busacando a primeira ocorência da string em "genres"
-        if (!genre.empty() && m.genres.find(genre) == std::string::npos) continue;
+    if (ctx.neighbors.neighborsPerMovie() == 0) {
+        sink.message("Item neighbors not built (start with --neighbors K)");
+        return;
+    }
 
-        double avg = m.ratingSum / static_cast<double>(m.ratingCount);
+    int user = ctx.users.indexOf(userId);
+    if (user < 0) {
+        sink.message("User not found");
+        return;
+    }
 
-        results.push_back(TopResult{
-            m.movieId,
-            m.title,
-            m.genres,
-            avg,
-            m.ratingCount
-        });
+    const MovieStore& movies = ctx.movies;
+    RatingSpan ratings = ctx.users.ratings(user);
+    if (ratings.size == 0) {
+        sink.beginTable(kRecommendTable);
+        sink.endTable();
+        return;
+    }
+
+    double mean = 0.0;
+    for (std::size_t i = 0; i < ratings.size; ++i) {
+        mean += ratings.rating(i);
+    }
+    mean /= static_cast<double>(ratings.size);
+
+    std::vector<std::uint8_t> seen(movies.size(), 0);
+    for (std::size_t i = 0; i < ratings.size; ++i) {
+        seen[ratings.movies[i]] = 1;
+    }
+
+    std::vector<double> weighted(movies.size(), 0.0);
+    std::vector<double> weights(movies.size(), 0.0);
+    std::vector<int> support(movies.size(), 0);
+    std::vector<int> touched;
+
+    for (std::size_t i = 0; i < ratings.size; ++i) {
+        double dev = ratings.rating(i) - mean;
+        NeighborSpan near = ctx.neighbors.neighbors(ratings.movies[i]);
+        metrics::addScanned(near.size);
+        for (std::size_t k = 0; k < near.size; ++k) {
+            int j = near.movies[k];
+            if (seen[j]) continue;
+            if (support[j] == 0) touched.push_back(j);
+            ++support[j];
+            weighted[j] += near.sims[k] * dev;
+            weights[j] += near.sims[k];
+        }
+    }
+
+    struct Recommendation {
+        int movieId;
+        int movie;
+        double predicted;
+        double weight;
+    };
+
+    std::vector<Recommendation> results;
+    for (int j : touched) {
+        if (support[j] < kMinSupport) continue;
+        results.push_back(Recommendation{movies.movieId(j), j, mean + weighted[j] / weights[j], weights[j]});
     }
 
     if (results.empty()) {
+        sink.message("No recommendations");
         return;
     }
 
-    // Ordena por média global desc, depois ratingCount desc, depois movieId asc
-    sort_utils::quickSort(results, [](const TopResult& a, const TopResult& b) {
-        if (a.avg != b.avg) return a.avg > b.avg;
-        if (a.ratingCount != b.ratingCount) return a.ratingCount > b.ratingCount;
+    // Maior nota prevista; no empate, mais peso de vizinhos, depois o menor movieId
+    metrics::addSorted(results.size());
+    sort_utils::selectTop(results, static_cast<std::size_t>(n), [](const Recommendation& a, const Recommendation& b) {
+        if (a.predicted != b.predicted) return a.predicted > b.predicted;
+        if (a.weight != b.weight) return a.weight > b.weight;
         return a.movieId < b.movieId;
     });
 
-    std::cout << std::fixed << std::setprecision(6);
+    sink.beginTable(kRecommendTable);
+    for (const auto& r : results) {
+        movieCells(sink, r.movieId, movies.title(r.movie), movies.genres(r.movie));
+        sink.real(r.predicted);
+        sink.real(movies.average(r.movie));
+        sink.integer(movies.ratingCount(r.movie));
+        sink.endRow();
+    }
+    sink.endTable();
+}
 
-    int limit = static_cast<int>(results.size());
-    if (n < limit) limit = n;
-    if (limit == 0) {
+// Os N filmes mais parecidos com o filme, calculados na hora sobre todos os candidatos
+// (cosseno ajustado, o mesmo da tabela de vizinhos)
+void querySimilar(const DataContext& ctx, ResultSink& sink, int movieId, int n, unsigned threads) {
+    const MovieStore& movies = ctx.movies;
+    int idx = movies.indexOf(movieId);
+    if (idx < 0) {
+        sink.message("Movie not found");
         return;
     }
 
-    // Cabeçalho
-    std::cout
-        << std::setw(6)  << "ID"
-        << " | " << std::setw(40) << "Title"
-        << " | " << std::setw(25) << "Genres"
-        << " | " << std::setw(6)  << "Year"
-        << " | " << std::setw(10) << "AvgRate"
-        << " | " << std::setw(8)  << "Ratings"
-        << '\n';
+    // Todos os candidatos são comparados: as avaliações de todos os filmes são lidas
+    metrics::addScanned(ctx.centered.entryCount());
+    std::vector<similarity::Match> results =
+        similarity::mostSimilar(ctx.movieRatings, ctx.centered, movies, idx, static_cast<std::size_t>(n), threads);
+
+    sink.beginTable(kSimilarTable);
+    for (const auto& r : results) {
+        movieCells(sink, movies.movieId(r.movie), movies.title(r.movie), movies.genres(r.movie));
+        sink.real(r.sim);
+        sink.integer(r.common);
+        sink.real(movies.average(r.movie));
+        sink.integer(movies.ratingCount(r.movie));
+        sink.endRow();
+    }
+    sink.endTable();
+}
+
+void queryTop(const DataContext& ctx, ResultSink& sink, int n, const std::string& genre, GenreMatch match) {
+    if (n <= 0) {
+        return;
+    }
 
-    std::cout << std::string(110, '-') << '\n';
+    // O índice de gêneros já tem os filmes com 1000+ avaliações (requisito do enunciado)
+    // na ordem média desc, ratingCount desc, movieId asc: basta pegar os N primeiros
+    const MovieStore& movies = ctx.movies;
+    std::vector<int> results = ctx.genreIndex.top(movies, genre, match, static_cast<std::size_t>(n));
+    metrics::addScanned(results.size());
+
+    int limit = static_cast<int>(results.size());
+    if (n < limit) limit = n;
 
     // Linhas (respeitando o limite N)
+    sink.beginTable(kTopTable);
     for (int i = 0; i < limit; ++i) {
-        const auto& r = results[i];
+        int idx = results[i];
 
-        std::string genres = extractGenres(r.genres); // antes da vírgula
-        std::string year   = extractYear(r.genres);   // depois da vírgula
-
-        std::cout
-            << std::setw(6)  << r.movieId
-            << " | " << std::setw(40) << r.title.substr(0, 40)
-            << " | " << std::setw(25) << genres.substr(0, 25)
-            << " | " << std::setw(6)  << year
-            << " | " << std::setw(10) << r.avg
-            << " | " << std::setw(8)  << r.ratingCount
-            << '\n';
+        movieCells(sink, movies.movieId(idx), movies.title(idx), movies.genres(idx));
+        sink.real(movies.average(idx));
+        sink.integer(movies.ratingCount(idx));
+        sink.endRow();
     }
+    sink.endTable();
 }
 
 
-void queryTags(DataContext& ctx, const std::vector<std::string>& tags) {
-    struct TagResult {
-        int movieId;
-        std::string title;
-        std::string genres;
-        double avg;
-        int ratingCount;
-    };
-
+void queryTags(const DataContext& ctx, ResultSink& sink, const std::vector<TagToken>& tags) {
     if (tags.empty()) {
         return;
     }
 
- // Get movie lists for each tag
-    std::vector<std::vector<int>> tagMovieLists;
-    tagMovieLists.reserve(tags.size());
-
+    // Com "|" ou "-tag" a consulta é uma expressão booleana, avaliada sobre os bitmaps
     for (const auto& t : tags) {
-        std::string norm = normalizeTag(t);
-        if (norm.empty()) {
-            tagMovieLists.push_back(std::vector<int>{});
-            continue;
-        }
-        tagMovieLists.push_back(ctx.tags.getMovies(norm));
-    }
-
-
-    // If any list is empty, intersection is empty
-    for (const auto& lst : tagMovieLists) {
-        if (lst.empty()) {
+        if (isTagOperator(t)) {
+            queryTagExpression(ctx, sink, tags);
             return;
         }
     }
 
-    // Find index of smallest list
-    std::size_t smallestIdx = 0;
-    for (std::size_t i = 1; i < tagMovieLists.size(); ++i) {
-        if (tagMovieLists[i].size() < tagMovieLists[smallestIdx].size()) {
-            smallestIdx = i;
-        }
-    }
+ // Get movie lists for each tag (listas ordenadas e sem duplicatas, ver TagHashTable::finalize)
+    // Tags grandes só têm bitmap (ver TagHashTable::buildBitmaps); as outras, a lista
+    std::vector<const std::vector<int>*> tagMovieLists;
+    std::vector<const RoaringBitmap*> tagBitmaps;
+    tagMovieLists.reserve(tags.size());
 
-    const auto& baseList = tagMovieLists[smallestIdx];
     std::vector<int> intersection;
-    intersection.reserve(baseList.size());
 
-    for (int id : baseList) {
-        bool inAll = true;
-        for (std::size_t j = 0; j < tagMovieLists.size(); ++j) {
-            if (j == smallestIdx) continue;
-            const auto& lst = tagMovieLists[j];
-            bool found = false;
-            for (int otherId : lst) {
-                if (otherId == id) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                inAll = false;
-                break;
-            }
+    for (const auto& t : tags) {
+        std::string norm = normalizeTag(t.text);
+        const TagEntry* entry = norm.empty() ? nullptr : ctx.tags.find(norm);
+
+        // If any list is empty, intersection is empty
+        if (entry == nullptr || ctx.tags.movieCount(*entry) == 0) {
+            printTagResults(ctx, sink, intersection);
+            return;
         }
-        if (inAll) {
-            intersection.push_back(id);
+        if (entry->bitmap >= 0) {
+            tagBitmaps.push_back(&ctx.tags.bitmapAt(entry->bitmap));
+        } else {
+            tagMovieLists.push_back(&entry->movieIds);
         }
+        metrics::addScanned(ctx.tags.movieCount(*entry));
     }
 
-    if (intersection.empty()) {
-        return;
-    }
-
-    std::vector<TagResult> results;
-    results.reserve(intersection.size());
-
-    for (int id : intersection) {
-        Movie* m = ctx.movies.find(id);
-        if (!m) continue;
-        if (m->ratingCount <= 0) continue;
-
-        double avg = m->ratingSum / static_cast<double>(m->ratingCount);
-        results.push_back(TagResult{
-            m->movieId,
-            m->title,
-            m->genres,
-            avg,
-            m->ratingCount
-        });
-    }
-
-    if (results.empty()) {
+    // Interseção das listas ordenadas, da menor para a maior
+    if (tagBitmaps.empty()) {
+        intersect::intersectAll(tagMovieLists, intersection);
+        printTagResults(ctx, sink, intersection);
         return;
     }
 
-    // Ordena por média global desc, depois ratingCount desc, depois movieId asc
-    sort_utils::quickSort(results, [](const TagResult& a, const TagResult& b) {
-        if (a.avg != b.avg) return a.avg > b.avg;
-        if (a.ratingCount != b.ratingCount) return a.ratingCount > b.ratingCount;
-        return a.movieId < b.movieId;
+    // Com bitmaps, os candidatos (a interseção das listas, ou o menor bitmap) são testados
+    // um a um nos bitmaps restantes, sem montar bitmaps intermediários
+    sort_utils::quickSort(tagBitmaps, [](const RoaringBitmap* a, const RoaringBitmap* b) {
+        return a->cardinality() < b->cardinality();
     });
 
-        std::cout << std::fixed << std::setprecision(6);
-
-    std::cout
-        << std::setw(6)  << "ID"
-        << " | " << std::setw(40) << "Title"
-        << " | " << std::setw(25) << "Genres"
-        << " | " << std::setw(6)  << "Year"
-        << " | " << std::setw(10) << "AvgRate"
-        << " | " << std::setw(8)  << "count"
-        << '\n';
-
-    std::cout << std::string(105, '-') << '\n';
-
-
-    for (const auto& r : results) {
-        std::string genres = extractGenres(r.genres);
-        std::string year   = extractYear(r.genres);
-
-        std::cout
-            << std::setw(6)  << r.movieId
-            << " | " << std::setw(40) << r.title.substr(0,40)
-            << " | " << std::setw(25) << genres.substr(0,25)
-            << " | " << std::setw(6)  << year
-            << " | " << std::setw(10) << r.avg
-            << " | " << std::setw(8)  << r.ratingCount
-            << '\n';
+    const std::vector<int>& denseIds = ctx.denseMovieIds;
+    std::vector<std::uint32_t> dense;
+    std::size_t firstBitmap = 0;
+    if (!tagMovieLists.empty()) {
+        intersect::intersectAll(tagMovieLists, intersection);
+        // movieId -> índice denso; os dois vetores estão em ordem crescente
+        auto pos = denseIds.begin();
+        for (int id : intersection) {
+            pos = std::lower_bound(pos, denseIds.end(), id);
+            if (pos == denseIds.end()) break;
+            if (*pos == id) dense.push_back(static_cast<std::uint32_t>(pos - denseIds.begin()));
+        }
+    } else {
+        tagBitmaps[0]->toVector(dense);
+        firstBitmap = 1;
     }
 
+    intersection.clear();
+    for (std::uint32_t d : dense) {
+        bool inAll = true;
+        for (std::size_t i = firstBitmap; i < tagBitmaps.size() && inAll; ++i) {
+            inAll = tagBitmaps[i]->contains(d);
+        }
+        if (inAll) intersection.push_back(denseIds[d]);
+    }
+    printTagResults(ctx, sink, intersection);
 }
 
 } // namespace queries
\ No newline at end of file
@@ -0,0 +1,282 @@
+#include "result_sink.hpp"
+
+#include <cmath>
+
+namespace {
+
+// Texto com os caracteres que quebrariam o TSV escapados (\t, \n, \r e a própria barra)
+void writeTsvText(TableWriter& writer, std::string_view value) {
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        char c = value[i];
+        const char* escaped = nullptr;
+        switch (c) {
+            case '\t': escaped = "\\t"; break;
+            case '\n': escaped = "\\n"; break;
+            case '\r': escaped = "\\r"; break;
+            case '\\': escaped = "\\\\"; break;
+            default: continue;
+        }
+        writer.text(value.substr(start, i - start)).text(escaped);
+        start = i + 1;
+    }
+    writer.text(value.substr(start));
+}
+
+// Só dígitos, sem zero à esquerda: pode ir para o JSON como número
+bool isJsonInteger(std::string_view value) {
+    if (value.empty() || value.size() > 18) return false;
+    if (value.size() > 1 && value[0] == '0') return false;
+    for (char c : value) {
+        if (c < '0' || c > '9') return false;
+    }
+    return true;
+}
+
+} // namespace
+
+/* ------------------------------------------------------------------
+   TableSink
+------------------------------------------------------------------ */
+
+TableSink::TableSink(std::ostream& out) : writer(out) {}
+
+void TableSink::endResult() {
+    writer.flush();
+}
+
+void TableSink::beginTable(const TableSpec& table) {
+    spec = &table;
+    column = 0;
+    headerWritten = false;
+}
+
+// Escreve o cabeçalho antes da primeira célula (tabela vazia não tem cabeçalho) e o
+// separador/rótulo da célula
+const Column& TableSink::beginCell() {
+    if (spec->style == TableStyle::Grid && !headerWritten) {
+        if (spec->blankLineBefore) writer.endLine();
+        for (std::size_t c = 0; c < spec->columnCount; ++c) {
+            if (c > 0) writer.text(" | ");
+            writer.right(spec->columns[c].header, spec->columns[c].width);
+        }
+        writer.endLine();
+        writer.repeat('-', spec->rule).endLine();
+        headerWritten = true;
+    }
+
+    const Column& col = spec->columns[column++];
+    if (column > 1) writer.text(" | ");
+    if (spec->style == TableStyle::Labeled) writer.text(col.header);
+    return col;
+}
+
+void TableSink::integer(long long value) {
+    const Column& col = beginCell();
+    writer.number(value, col.width);
+}
+
+void TableSink::real(double value) {
+    const Column& col = beginCell();
+    writer.fixed(value, col.precision, col.width);
+}
+
+void TableSink::text(std::string_view value) {
+    const Column& col = beginCell();
+    if (col.maxChars > 0) value = value.substr(0, col.maxChars);
+    writer.right(value, col.width);
+}
+
+void TableSink::endRow() {
+    ++rows;
+    writer.endLine();
+    column = 0;
+}
+
+void TableSink::message(std::string_view text) {
+    writer.text(text).endLine();
+}
+
+/* ------------------------------------------------------------------
+   TsvSink
+------------------------------------------------------------------ */
+
+TsvSink::TsvSink(std::ostream& out) : writer(out) {}
+
+void TsvSink::endResult() {
+    writer.flush();
+}
+
+void TsvSink::beginTable(const TableSpec& table) {
+    spec = &table;
+    column = 0;
+    firstCell = true;
+
+    bool first = true;
+    for (std::size_t c = 0; c < table.columnCount; ++c) {
+        if (table.columns[c].tableOnly) continue;
+        if (!first) writer.text('\t');
+        writer.text(table.columns[c].key);
+        first = false;
+    }
+    writer.endLine();
+}
+
+void TsvSink::endTable() {
+    writer.endLine();
+}
+
+bool TsvSink::beginCell() {
+    const Column& col = spec->columns[column++];
+    if (col.tableOnly) return false;
+    if (!firstCell) writer.text('\t');
+    firstCell = false;
+    return true;
+}
+
+void TsvSink::integer(long long value) {
+    if (beginCell()) writer.number(value);
+}
+
+void TsvSink::real(double value) {
+    if (beginCell()) writer.number(value);
+}
+
+void TsvSink::text(std::string_view value) {
+    if (beginCell()) writeTsvText(writer, value);
+}
+
+void TsvSink::endRow() {
+    ++rows;
+    writer.endLine();
+    column = 0;
+    firstCell = true;
+}
+
+void TsvSink::message(std::string_view text) {
+    writer.text("message").endLine();
+    writeTsvText(writer, text);
+    writer.endLine().endLine();
+}
+
+/* ------------------------------------------------------------------
+   JsonSink
+------------------------------------------------------------------ */
+
+JsonSink::JsonSink(std::ostream& out) : writer(out) {}
+
+void JsonSink::endResult() {
+    if (inResult) writer.text('}').endLine();
+    inResult = false;
+    writer.flush();
+}
+
+// Abre o objeto do comando na primeira seção; vírgula antes das seguintes
+void JsonSink::beginSection() {
+    writer.text(inResult ? ',' : '{');
+    inResult = true;
+}
+
+void JsonSink::beginTable(const TableSpec& table) {
+    spec = &table;
+    column = 0;
+    firstRow = true;
+    firstField = true;
+
+    beginSection();
+    string(table.key);
+    writer.text(table.style == TableStyle::Grid ? ":[" : ":{");
+}
+
+void JsonSink::endTable() {
+    writer.text(spec->style == TableStyle::Grid ? ']' : '}');
+}
+
+// Abre o objeto da linha (Grid) e escreve a chave da célula; false se a coluna for só da tabela
+bool JsonSink::beginCell() {
+    bool firstInRow = column == 0;
+    const Column& col = spec->columns[column++];
+    if (firstInRow && spec->style == TableStyle::Grid) {
+        if (!firstRow) writer.text(',');
+        writer.text('{');
+        firstRow = false;
+    }
+    if (col.tableOnly) return false;
+
+    if (!firstField) writer.text(',');
+    firstField = false;
+    string(col.key);
+    writer.text(':');
+    return true;
+}
+
+void JsonSink::integer(long long value) {
+    if (beginCell()) writer.number(value);
+}
+
+void JsonSink::real(double value) {
+    if (!beginCell()) return;
+    if (std::isfinite(value)) {
+        writer.number(value);
+    } else {
+        writer.text("null");
+    }
+}
+
+void JsonSink::text(std::string_view value) {
+    const Column& col = spec->columns[column];
+    if (!beginCell()) return;
+    if (col.type == ColumnType::IntegerText) {
+        if (value.empty()) {
+            writer.text("null");
+            return;
+        }
+        if (isJsonInteger(value)) {
+            writer.text(value);
+            return;
+        }
+    }
+    string(value);
+}
+
+void JsonSink::endRow() {
+    ++rows;
+    if (spec->style == TableStyle::Grid) writer.text('}');
+    column = 0;
+    firstField = true;
+}
+
+void JsonSink::message(std::string_view text) {
+    beginSection();
+    string("message");
+    writer.text(':');
+    string(text);
+}
+
+// String JSON: aspas, barra e caracteres de controle escapados; o resto (UTF-8) passa direto
+void JsonSink::string(std::string_view value) {
+    static const char kHex[] = "0123456789abcdef";
+
+    writer.text('"');
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        writer.text(value.substr(start, i - start));
+        switch (c) {
+            case '"': writer.text("\\\""); break;
+            case '\\': writer.text("\\\\"); break;
+            case '\n': writer.text("\\n"); break;
+            case '\r': writer.text("\\r"); break;
+            case '\t': writer.text("\\t"); break;
+            default: {
+                char escaped[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xf]};
+                writer.text(std::string_view(escaped, 6));
+            }
+        }
+        start = i + 1;
+    }
+    writer.text(value.substr(start));
+    writer.text('"');
+}
@@ -0,0 +1,335 @@
+#include "roaring.hpp"
+
+namespace {
+
+const std::uint32_t kArrayLimit = 4096;
+const std::size_t kBitmapWords = 1024;
+
+std::uint32_t countBits(const std::vector<std::uint64_t>& bits) {
+    std::uint32_t total = 0;
+    for (std::uint64_t w : bits) {
+        total += static_cast<std::uint32_t>(__builtin_popcountll(w));
+    }
+    return total;
+}
+
+bool testBit(const std::vector<std::uint64_t>& bits, std::uint16_t v) {
+    return (bits[v >> 6] >> (v & 63)) & 1;
+}
+
+void toBitmap(RoaringContainer& c) {
+    if (c.isBitmap()) return;
+    c.bits.assign(kBitmapWords, 0);
+    for (std::uint16_t v : c.array) {
+        c.bits[v >> 6] |= std::uint64_t(1) << (v & 63);
+    }
+    std::vector<std::uint16_t>().swap(c.array);
+}
+
+// Escolhe a representação pela cardinalidade: array até 4096 valores, bitmap acima
+void normalize(RoaringContainer& c) {
+    if (c.isBitmap() && c.cardinality <= kArrayLimit) {
+        std::vector<std::uint16_t> values;
+        values.reserve(c.cardinality);
+        for (std::size_t w = 0; w < kBitmapWords; ++w) {
+            std::uint64_t word = c.bits[w];
+            while (word != 0) {
+                int bit = __builtin_ctzll(word);
+                values.push_back(static_cast<std::uint16_t>(w * 64 + static_cast<std::size_t>(bit)));
+                word &= word - 1;
+            }
+        }
+        c.array.swap(values);
+        std::vector<std::uint64_t>().swap(c.bits);
+    } else if (!c.isBitmap() && c.cardinality > kArrayLimit) {
+        toBitmap(c);
+    }
+}
+
+RoaringContainer containerAnd(const RoaringContainer& a, const RoaringContainer& b) {
+    RoaringContainer out;
+
+    if (!a.isBitmap() && !b.isBitmap()) {
+        std::size_t i = 0, j = 0;
+        while (i < a.array.size() && j < b.array.size()) {
+            if (a.array[i] < b.array[j]) {
+                ++i;
+            } else if (b.array[j] < a.array[i]) {
+                ++j;
+            } else {
+                out.array.push_back(a.array[i]);
+                ++i;
+                ++j;
+            }
+        }
+    } else if (!a.isBitmap() || !b.isBitmap()) {
+        const RoaringContainer& arr = a.isBitmap() ? b : a;
+        const RoaringContainer& bmp = a.isBitmap() ? a : b;
+        for (std::uint16_t v : arr.array) {
+            if (testBit(bmp.bits, v)) out.array.push_back(v);
+        }
+    } else {
+        out.bits.resize(kBitmapWords);
+        for (std::size_t w = 0; w < kBitmapWords; ++w) {
+            out.bits[w] = a.bits[w] & b.bits[w];
+        }
+        out.cardinality = countBits(out.bits);
+        normalize(out);
+        return out;
+    }
+
+    out.cardinality = static_cast<std::uint32_t>(out.array.size());
+    return out;
+}
+
+RoaringContainer containerOr(const RoaringContainer& a, const RoaringContainer& b) {
+    RoaringContainer out;
+
+    if (!a.isBitmap() && !b.isBitmap()) {
+        std::size_t i = 0, j = 0;
+        out.array.reserve(a.array.size() + b.array.size());
+        while (i < a.array.size() || j < b.array.size()) {
+            if (j == b.array.size() || (i < a.array.size() && a.array[i] < b.array[j])) {
+                out.array.push_back(a.array[i++]);
+            } else if (i == a.array.size() || b.array[j] < a.array[i]) {
+                out.array.push_back(b.array[j++]);
+            } else {
+                out.array.push_back(a.array[i]);
+                ++i;
+                ++j;
+            }
+        }
+        out.cardinality = static_cast<std::uint32_t>(out.array.size());
+        normalize(out);
+        return out;
+    }
+
+    const RoaringContainer& bmp = a.isBitmap() ? a : b;
+    const RoaringContainer& other = a.isBitmap() ? b : a;
+    out.bits = bmp.bits;
+    if (other.isBitmap()) {
+        for (std::size_t w = 0; w < kBitmapWords; ++w) {
+            out.bits[w] |= other.bits[w];
+        }
+    } else {
+        for (std::uint16_t v : other.array) {
+            out.bits[v >> 6] |= std::uint64_t(1) << (v & 63);
+        }
+    }
+    out.cardinality = countBits(out.bits);
+    return out;
+}
+
+RoaringContainer containerAndNot(const RoaringContainer& a, const RoaringContainer& b) {
+    RoaringContainer out;
+
+    if (!a.isBitmap()) {
+        if (b.isBitmap()) {
+            for (std::uint16_t v : a.array) {
+                if (!testBit(b.bits, v)) out.array.push_back(v);
+            }
+        } else {
+            std::size_t j = 0;
+            for (std::uint16_t v : a.array) {
+                while (j < b.array.size() && b.array[j] < v) ++j;
+                if (j == b.array.size() || b.array[j] != v) out.array.push_back(v);
+            }
+        }
+        out.cardinality = static_cast<std::uint32_t>(out.array.size());
+        return out;
+    }
+
+    out.bits = a.bits;
+    if (b.isBitmap()) {
+        for (std::size_t w = 0; w < kBitmapWords; ++w) {
+            out.bits[w] &= ~b.bits[w];
+        }
+    } else {
+        for (std::uint16_t v : b.array) {
+            out.bits[v >> 6] &= ~(std::uint64_t(1) << (v & 63));
+        }
+    }
+    out.cardinality = countBits(out.bits);
+    normalize(out);
+    return out;
+}
+
+} // namespace
+
+RoaringBitmap RoaringBitmap::fromSorted(const std::vector<std::uint32_t>& values) {
+    RoaringBitmap result;
+
+    for (std::uint32_t v : values) {
+        std::uint16_t key = static_cast<std::uint16_t>(v >> 16);
+        if (result.keys.empty() || result.keys.back() != key) {
+            result.keys.push_back(key);
+            result.containers.emplace_back();
+        }
+        result.containers.back().array.push_back(static_cast<std::uint16_t>(v & 0xFFFF));
+    }
+
+    for (RoaringContainer& c : result.containers) {
+        c.cardinality = static_cast<std::uint32_t>(c.array.size());
+        normalize(c);
+        c.array.shrink_to_fit();
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::range(std::uint32_t n) {
+    RoaringBitmap result;
+
+    for (std::uint32_t start = 0; start < n; start += 65536) {
+        std::uint32_t count = n - start < 65536 ? n - start : 65536;
+
+        RoaringContainer c;
+        c.bits.assign(kBitmapWords, 0);
+        for (std::uint32_t w = 0; w < count / 64; ++w) {
+            c.bits[w] = ~std::uint64_t(0);
+        }
+        if (count % 64 != 0) {
+            c.bits[count / 64] = (std::uint64_t(1) << (count % 64)) - 1;
+        }
+        c.cardinality = count;
+        normalize(c);
+
+        result.keys.push_back(static_cast<std::uint16_t>(start >> 16));
+        result.containers.push_back(std::move(c));
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::andWith(const RoaringBitmap& other) const {
+    RoaringBitmap result;
+    std::size_t i = 0, j = 0;
+
+    while (i < keys.size() && j < other.keys.size()) {
+        if (keys[i] < other.keys[j]) {
+            ++i;
+        } else if (other.keys[j] < keys[i]) {
+            ++j;
+        } else {
+            RoaringContainer c = containerAnd(containers[i], other.containers[j]);
+            if (c.cardinality > 0) {
+                result.keys.push_back(keys[i]);
+                result.containers.push_back(std::move(c));
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::orWith(const RoaringBitmap& other) const {
+    RoaringBitmap result;
+    std::size_t i = 0, j = 0;
+
+    while (i < keys.size() || j < other.keys.size()) {
+        if (j == other.keys.size() || (i < keys.size() && keys[i] < other.keys[j])) {
+            result.keys.push_back(keys[i]);
+            result.containers.push_back(containers[i]);
+            ++i;
+        } else if (i == keys.size() || other.keys[j] < keys[i]) {
+            result.keys.push_back(other.keys[j]);
+            result.containers.push_back(other.containers[j]);
+            ++j;
+        } else {
+            result.keys.push_back(keys[i]);
+            result.containers.push_back(containerOr(containers[i], other.containers[j]));
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::andNot(const RoaringBitmap& other) const {
+    RoaringBitmap result;
+    std::size_t j = 0;
+
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        while (j < other.keys.size() && other.keys[j] < keys[i]) ++j;
+
+        if (j < other.keys.size() && other.keys[j] == keys[i]) {
+            RoaringContainer c = containerAndNot(containers[i], other.containers[j]);
+            if (c.cardinality > 0) {
+                result.keys.push_back(keys[i]);
+                result.containers.push_back(std::move(c));
+            }
+        } else {
+            result.keys.push_back(keys[i]);
+            result.containers.push_back(containers[i]);
+        }
+    }
+    return result;
+}
+
+// Busca binária do container pelos 16 bits altos, depois no array ou no bitmap do container
+bool RoaringBitmap::contains(std::uint32_t value) const {
+    std::uint16_t high = static_cast<std::uint16_t>(value >> 16);
+    std::uint16_t low = static_cast<std::uint16_t>(value & 0xFFFF);
+
+    std::size_t lo = 0, hi = keys.size();
+    while (lo < hi) {
+        std::size_t mid = (lo + hi) / 2;
+        if (keys[mid] < high) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == keys.size() || keys[lo] != high) return false;
+
+    const RoaringContainer& c = containers[lo];
+    if (c.isBitmap()) return testBit(c.bits, low);
+
+    std::size_t a = 0, b = c.array.size();
+    while (a < b) {
+        std::size_t mid = (a + b) / 2;
+        if (c.array[mid] < low) a = mid + 1;
+        else b = mid;
+    }
+    return a < c.array.size() && c.array[a] == low;
+}
+
+bool RoaringBitmap::empty() const {
+    return keys.empty();
+}
+
+std::size_t RoaringBitmap::cardinality() const {
+    std::size_t total = 0;
+    for (const RoaringContainer& c : containers) {
+        total += c.cardinality;
+    }
+    return total;
+}
+
+void RoaringBitmap::toVector(std::vector<std::uint32_t>& out) const {
+    out.clear();
+    out.reserve(cardinality());
+
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        std::uint32_t high = static_cast<std::uint32_t>(keys[i]) << 16;
+        const RoaringContainer& c = containers[i];
+
+        if (!c.isBitmap()) {
+            for (std::uint16_t v : c.array) out.push_back(high | v);
+            continue;
+        }
+        for (std::size_t w = 0; w < kBitmapWords; ++w) {
+            std::uint64_t word = c.bits[w];
+            while (word != 0) {
+                int bit = __builtin_ctzll(word);
+                out.push_back(high | static_cast<std::uint32_t>(w * 64 + static_cast<std::size_t>(bit)));
+                word &= word - 1;
+            }
+        }
+    }
+}
+
+std::size_t RoaringBitmap::memoryUsage() const {
+    std::size_t total = keys.capacity() * sizeof(std::uint16_t)
+                      + containers.capacity() * sizeof(RoaringContainer);
+    for (const RoaringContainer& c : containers) {
+        total += c.array.capacity() * sizeof(std::uint16_t) + c.bits.capacity() * sizeof(std::uint64_t);
+    }
+    return total;
+}
@@ -0,0 +1,485 @@
+#include "server.hpp"
+#include "thread_pool.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// Comandos de uma conexão em execução ou com a resposta esperando a vez de ser enviada
+const std::size_t kMaxInFlight = 64;
+// Saída pendente acima da qual a conexão para de ser lida até o cliente consumir
+const std::size_t kMaxPendingOutput = 8u << 20;
+// Linha maior que isto sem '\n': a conexão é fechada
+const std::size_t kMaxLineLength = 1u << 20;
+const std::size_t kReadChunk = 64u << 10;
+const int kMaxEvents = 64;
+
+// Fim da resposta de um comando (nenhuma linha de saída das consultas é só ".")
+const char kEndOfResponse[] = ".\n";
+
+struct Response {
+    std::string text;
+    bool done = false;
+};
+
+struct Connection {
+    int fd = -1;
+    std::string input;              // bytes recebidos; as linhas começam em inputStart
+    std::size_t inputStart = 0;
+    std::deque<Response> responses; // um por comando, na ordem dos pedidos
+    std::string output;             // respostas prontas; já enviado até outputSent
+    std::size_t outputSent = 0;
+    bool readClosed = false;        // o cliente fechou o envio (ou a conexão quebrou)
+    bool broken = false;            // erro de leitura/escrita: as respostas são descartadas
+    bool registered = true;         // ainda está no epoll
+    std::uint32_t events = EPOLLIN; // máscara registrada no epoll
+};
+
+std::string errnoText(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+class Server {
+public:
+    Server(const DataContext& ctx, const server::Options& options) : ctx(ctx), options(options) {}
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    bool open(std::string& error);
+    void loop();
+
+    std::size_t commands() const { return commandCount; }
+    std::size_t accepted() const { return connectionCount; }
+
+private:
+    const DataContext& ctx;
+    server::Options options;
+
+    int epollFd = -1;
+    int signalFd = -1;
+    int wakeFd = -1; // eventfd: as threads avisam que terminaram um comando
+    int unixFd = -1;
+    int tcpFd = -1;
+
+    // Conexões indexadas pelo fd
+    std::vector<std::unique_ptr<Connection>> connections;
+
+    // Protege os Response de todas as conexões e completed
+    std::mutex mtx;
+    std::vector<int> completed; // fds com respostas novas
+
+    std::size_t commandCount = 0;
+    std::size_t connectionCount = 0;
+
+    // Por último: é destruído primeiro, antes do que as tarefas usam
+    std::unique_ptr<ThreadPool> pool;
+
+    bool watch(int fd, std::string& error);
+    bool listenUnix(std::string& error);
+    bool listenTcp(std::string& error);
+
+    void acceptAll(int listenFd);
+    void readInput(Connection& conn);
+    void parseLines(Connection& conn);
+    void submit(Connection& conn, std::string line);
+    void drainCompletions();
+    void collect(Connection& conn);
+    void writeOutput(Connection& conn);
+    void update(Connection& conn);
+    void close(Connection& conn);
+};
+
+Server::~Server() {
+    if (pool) pool->wait();
+
+    for (auto& conn : connections) {
+        if (conn) ::close(conn->fd);
+    }
+    if (unixFd >= 0) {
+        ::close(unixFd);
+        ::unlink(options.unixPath.c_str());
+    }
+    if (tcpFd >= 0) ::close(tcpFd);
+    if (wakeFd >= 0) ::close(wakeFd);
+    if (signalFd >= 0) ::close(signalFd);
+    if (epollFd >= 0) ::close(epollFd);
+}
+
+bool Server::open(std::string& error) {
+    // SIGINT/SIGTERM chegam pelo signalfd; bloqueados antes de criar as threads do pool,
+    // que herdam a máscara
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        error = errnoText("epoll_create1");
+        return false;
+    }
+
+    signalFd = ::signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (signalFd < 0 || wakeFd < 0) {
+        error = errnoText("signalfd/eventfd");
+        return false;
+    }
+    if (!watch(signalFd, error) || !watch(wakeFd, error)) return false;
+
+    if (!options.unixPath.empty() && !listenUnix(error)) return false;
+    if (options.tcpPort >= 0 && !listenTcp(error)) return false;
+
+    pool.reset(new ThreadPool(options.threads));
+    return true;
+}
+
+bool Server::watch(int fd, std::string& error) {
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        error = errnoText("epoll_ctl");
+        return false;
+    }
+    return true;
+}
+
+bool Server::listenUnix(std::string& error) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (options.unixPath.size() >= sizeof(addr.sun_path)) {
+        error = "unix socket path too long";
+        return false;
+    }
+    std::memcpy(addr.sun_path, options.unixPath.c_str(), options.unixPath.size() + 1);
+
+    unixFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (unixFd < 0) {
+        error = errnoText("socket");
+        return false;
+    }
+
+    // Um arquivo de socket de uma execução anterior impediria o bind
+    ::unlink(options.unixPath.c_str());
+    if (::bind(unixFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(unixFd, SOMAXCONN) < 0) {
+        error = errnoText(options.unixPath);
+        ::close(unixFd);
+        unixFd = -1;
+        return false;
+    }
+    return watch(unixFd, error);
+}
+
+bool Server::listenTcp(std::string& error) {
+    tcpFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (tcpFd < 0) {
+        error = errnoText("socket");
+        return false;
+    }
+
+    int one = 1;
+    ::setsockopt(tcpFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    // Só localhost
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<std::uint16_t>(options.tcpPort));
+    if (::bind(tcpFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(tcpFd, SOMAXCONN) < 0) {
+        error = errnoText("127.0.0.1:" + std::to_string(options.tcpPort));
+        return false;
+    }
+    return watch(tcpFd, error);
+}
+
+void Server::loop() {
+    epoll_event events[kMaxEvents];
+    bool running = true;
+
+    while (running) {
+        int n = ::epoll_wait(epollFd, events, kMaxEvents, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "  " << errnoText("epoll_wait") << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            std::uint32_t ev = events[i].events;
+
+            if (fd == signalFd) {
+                running = false;
+            } else if (fd == wakeFd) {
+                drainCompletions();
+            } else if (fd == unixFd || fd == tcpFd) {
+                acceptAll(fd);
+            } else if (fd < static_cast<int>(connections.size()) && connections[fd]) {
+                Connection& conn = *connections[fd];
+                if (ev & (EPOLLHUP | EPOLLERR)) {
+                    // O cliente sumiu: nada mais do que for lido poderia ser respondido
+                    conn.readClosed = true;
+                    conn.broken = true;
+                } else {
+                    if (ev & EPOLLIN) readInput(conn);
+                    if (ev & EPOLLOUT) writeOutput(conn);
+                }
+                update(conn);
+            }
+        }
+    }
+}
+
+void Server::acceptAll(int listenFd) {
+    for (;;) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+
+        // Respostas pequenas saem na hora, sem esperar o Nagle
+        if (listenFd == tcpFd) {
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            ::close(fd);
+            continue;
+        }
+
+        if (connections.size() <= static_cast<std::size_t>(fd)) connections.resize(fd + 1);
+        connections[fd].reset(new Connection());
+        connections[fd]->fd = fd;
+        ++connectionCount;
+    }
+}
+
+// Uma leitura por evento (o epoll é level-triggered, então o resto vem no próximo)
+void Server::readInput(Connection& conn) {
+    if (conn.readClosed) return;
+
+    char buffer[kReadChunk];
+    ssize_t r = ::read(conn.fd, buffer, sizeof(buffer));
+    if (r > 0) {
+        conn.input.append(buffer, static_cast<std::size_t>(r));
+    } else if (r == 0) {
+        conn.readClosed = true;
+    } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        conn.readClosed = true;
+        conn.broken = true;
+    }
+    parseLines(conn);
+}
+
+// Transforma as linhas completas em comandos, até o limite de comandos em andamento
+void Server::parseLines(Connection& conn) {
+    if (conn.broken) return;
+
+    while (conn.responses.size() < kMaxInFlight) {
+        std::size_t newline = conn.input.find('\n', conn.inputStart);
+        if (newline == std::string::npos) {
+            std::size_t rest = conn.input.size() - conn.inputStart;
+            if (rest > kMaxLineLength) {
+                conn.readClosed = true;
+                conn.broken = true;
+            } else if (conn.readClosed && rest > 0) {
+                // Última linha sem '\n', como no getline do stdin
+                submit(conn, conn.input.substr(conn.inputStart));
+                conn.inputStart = conn.input.size();
+            }
+            break;
+        }
+
+        std::size_t end = newline;
+        if (end > conn.inputStart && conn.input[end - 1] == '\r') --end;
+        submit(conn, conn.input.substr(conn.inputStart, end - conn.inputStart));
+        conn.inputStart = newline + 1;
+    }
+
+    if (conn.inputStart == conn.input.size()) {
+        conn.input.clear();
+        conn.inputStart = 0;
+    } else if (conn.inputStart >= kReadChunk) {
+        conn.input.erase(0, conn.inputStart);
+        conn.inputStart = 0;
+    }
+}
+
+void Server::submit(Connection& conn, std::string line) {
+    Response* response;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        conn.responses.emplace_back();
+        response = &conn.responses.back();
+    }
+    ++commandCount;
+
+    // O Response só sai da fila depois de done, e a conexão só fecha com a fila vazia
+    int fd = conn.fd;
+    pool->submit([this, fd, response, line = std::move(line)] {
+        // Mensagens de erro vão depois do resultado, como no modo --batch
+        std::ostringstream out, err;
+        commands::execute(ctx, line, options.commands, out, err);
+        out << err.str() << kEndOfResponse;
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            response->text = out.str();
+            response->done = true;
+            completed.push_back(fd);
+        }
+        std::uint64_t one = 1;
+        ssize_t written = ::write(wakeFd, &one, sizeof(one));
+        (void)written;
+    });
+}
+
+void Server::drainCompletions() {
+    std::uint64_t count;
+    ssize_t r = ::read(wakeFd, &count, sizeof(count));
+    (void)r;
+
+    std::vector<int> fds;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        fds.swap(completed);
+    }
+
+    for (int fd : fds) {
+        if (fd >= static_cast<int>(connections.size()) || !connections[fd]) continue;
+        Connection& conn = *connections[fd];
+        collect(conn);
+        writeOutput(conn);
+        parseLines(conn);
+        update(conn);
+    }
+}
+
+// Passa para o buffer de saída as respostas prontas do começo da fila (a ordem dos pedidos
+// é mantida mesmo que um comando posterior termine antes)
+void Server::collect(Connection& conn) {
+    std::lock_guard<std::mutex> lock(mtx);
+    while (!conn.responses.empty() && conn.responses.front().done) {
+        if (!conn.broken) conn.output += conn.responses.front().text;
+        conn.responses.pop_front();
+    }
+}
+
+void Server::writeOutput(Connection& conn) {
+    while (!conn.broken && conn.outputSent < conn.output.size()) {
+        ssize_t w = ::send(conn.fd, conn.output.data() + conn.outputSent,
+                           conn.output.size() - conn.outputSent, MSG_NOSIGNAL);
+        if (w > 0) {
+            conn.outputSent += static_cast<std::size_t>(w);
+        } else if (w < 0 && errno == EINTR) {
+            continue;
+        } else if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            conn.readClosed = true;
+            conn.broken = true;
+        }
+    }
+
+    if (conn.broken || conn.outputSent == conn.output.size()) {
+        conn.output.clear();
+        conn.outputSent = 0;
+    } else if (conn.outputSent >= kReadChunk) {
+        conn.output.erase(0, conn.outputSent);
+        conn.outputSent = 0;
+    }
+}
+
+// Fecha a conexão terminada ou ajusta o que o epoll vigia: leitura enquanto houver espaço
+// para mais comandos e pouca saída pendente, escrita enquanto houver saída pendente
+void Server::update(Connection& conn) {
+    if (conn.readClosed && conn.responses.empty() && conn.output.empty()) {
+        close(conn);
+        return;
+    }
+
+    // Quebrada, só espera os comandos em andamento; fora do epoll para o EPOLLHUP não repetir
+    if (conn.broken) {
+        if (conn.registered) {
+            ::epoll_ctl(epollFd, EPOLL_CTL_DEL, conn.fd, nullptr);
+            conn.registered = false;
+        }
+        return;
+    }
+
+    std::size_t pending = conn.output.size() - conn.outputSent;
+    std::uint32_t want = 0;
+    if (!conn.readClosed && conn.responses.size() < kMaxInFlight && pending < kMaxPendingOutput) {
+        want |= EPOLLIN;
+    }
+    if (pending > 0) want |= EPOLLOUT;
+
+    if (want != conn.events) {
+        epoll_event ev{};
+        ev.events = want;
+        ev.data.fd = conn.fd;
+        ::epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+        conn.events = want;
+    }
+}
+
+void Server::close(Connection& conn) {
+    int fd = conn.fd;
+    if (conn.registered) ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections[fd].reset();
+}
+
+} // namespace
+
+namespace server {
+
+bool run(const DataContext& ctx, const Options& options, std::string& error) {
+    Server srv(ctx, options);
+    if (!srv.open(error)) return false;
+
+    std::cerr << "  serving on";
+    if (!options.unixPath.empty()) std::cerr << " unix:" << options.unixPath;
+    if (options.tcpPort >= 0) std::cerr << " tcp:127.0.0.1:" << options.tcpPort;
+    std::cerr << " with " << options.threads << (options.threads == 1 ? " thread" : " threads")
+              << " (SIGINT/SIGTERM to stop)" << std::endl;
+
+    srv.loop();
+
+    std::cerr << "  served " << srv.commands() << " commands on " << srv.accepted()
+              << " connections" << std::endl;
+    return true;
+}
+
+} // namespace server
@@ -0,0 +1,220 @@
+#include "similarity.hpp"
+#include "sort_utils.hpp"
+#include "thread_pool.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Abaixo disto os candidatos são avaliados na thread da consulta; criar o pool custaria mais
+const std::size_t kMinParallelEntries = 1 << 20;
+
+// Maior similaridade primeiro; no empate, o menor movieId
+struct CloserMatch {
+    const MovieStore* movies;
+
+    bool operator()(const similarity::Match& a, const similarity::Match& b) const {
+        if (a.sim != b.sim) return a.sim > b.sim;
+        return movies->movieId(a.movie) < movies->movieId(b.movie);
+    }
+};
+
+// Nota de cada código de meia estrela (código * 0.5): uma leitura no lugar da conversão
+struct HalfStars {
+    float value[256];
+
+    HalfStars() {
+        for (int c = 0; c < 256; ++c) value[c] = static_cast<float>(c) * 0.5f;
+    }
+};
+const HalfStars kHalfStars;
+
+// Soma em dot e count as avaliações [first, last) de raters (fora das repetições), com a nota
+// de cada uma dada por rating(i) e o desvio calculado na hora (nota - média do usuário)
+template <typename Rating>
+void accumulate(const float* dense, const float* presence, const CenteredSpan& raters,
+                std::size_t first, std::size_t last, Rating rating, float& dot, float& count) {
+    // Somas locais: em dot e count (referências) o compilador não as manteria em registrador
+    const std::int32_t* users = raters.users;
+    const float* means = raters.means;
+    float sumDot = dot;
+    float sumCount = count;
+    for (std::size_t i = first; i < last; ++i) {
+        int u = users[i];
+        sumDot += dense[u] * (rating(i) - means[u]);
+        sumCount += presence[u];
+    }
+    dot = sumDot;
+    count = sumCount;
+}
+
+// Uma variante do laço por representação das notas, para o teste não ficar no laço
+void accumulateRange(const float* dense, const float* presence, const CenteredSpan& raters,
+                     std::size_t first, std::size_t last, float& dot, float& count) {
+    if (raters.exact) {
+        const float* exact = raters.exact;
+        accumulate(dense, presence, raters, first, last, [exact](std::size_t i) { return exact[i]; }, dot, count);
+    } else {
+        const std::uint8_t* codes = raters.codes;
+        const float* stars = kHalfStars.value;
+        accumulate(dense, presence, raters, first, last, [codes, stars](std::size_t i) { return stars[codes[i]]; },
+                   dot, count);
+    }
+}
+
+#if defined(__AVX2__)
+// [first, last) de 8 em 8 avaliadores em dots/counts: gathers do vetor denso, da presença e das
+// médias nos índices dos avaliadores; o desvio é a nota (códigos de meia estrela ou float)
+// menos a média. O resto que não fecha 8 vai para dot/count.
+void accumulateAvx2(const float* dense, const float* presence, const CenteredSpan& raters,
+                    std::size_t first, std::size_t last, __m256& dots, __m256& counts, float& dot, float& count) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    std::size_t i = first;
+    for (; i + 8 <= last; i += 8) {
+        __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(raters.users + i));
+        __m256 d = _mm256_i32gather_ps(dense, idx, 4);
+        __m256 p = _mm256_i32gather_ps(presence, idx, 4);
+        __m256 rating = raters.exact
+            ? _mm256_loadu_ps(raters.exact + i)
+            : _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(
+                  _mm_loadl_epi64(reinterpret_cast<const __m128i*>(raters.codes + i)))), half);
+        __m256 dev = _mm256_sub_ps(rating, _mm256_i32gather_ps(raters.means, idx, 4));
+        dots = _mm256_add_ps(dots, _mm256_mul_ps(d, dev));
+        counts = _mm256_add_ps(counts, p);
+    }
+    accumulateRange(dense, presence, raters, i, last, dot, count);
+}
+#endif
+
+// Candidatos [first, last): os n melhores em out
+void scoreRange(const MovieRatings& byMovie, const CenteredRatings& centered, const float* dense, const float* presence,
+                int target, float targetNorm, int first, int last, std::size_t n,
+                const CloserMatch& closer, std::vector<similarity::Match>& out) {
+    out.clear();
+    for (int c = first; c < last; ++c) {
+        if (c == target) continue;
+        float norm = centered.norm(c);
+        if (norm == 0.0f) continue;
+
+        CenteredSpan raters = centered.raters(byMovie, c);
+        std::uint32_t common = 0;
+        float dot = similarity::sparseDot(dense, presence, raters, common);
+        if (common < similarity::kMinCommonRaters || dot <= 0.0f) continue;
+
+        out.push_back(similarity::Match{c, dot / (targetNorm * norm), common});
+    }
+    sort_utils::selectTop(out, n, closer);
+}
+
+} // namespace
+
+namespace similarity {
+
+float sparseDotScalar(const float* dense, const float* presence, const CenteredSpan& raters,
+                      std::uint32_t& common) {
+    // Trechos sem repetição direto do CSR; cada repetição entra uma vez, com o desvio médio
+    float dot = 0.0f;
+    float count = 0.0f;
+    std::size_t i = 0;
+    for (std::size_t k = 0; k < raters.runCount; ++k) {
+        const RepeatedRun& run = raters.runs[k];
+        accumulateRange(dense, presence, raters, i, run.position, dot, count);
+        dot += dense[raters.users[run.position]] * run.dev;
+        count += presence[raters.users[run.position]];
+        i = run.position + run.count;
+    }
+    accumulateRange(dense, presence, raters, i, raters.size, dot, count);
+    common = static_cast<std::uint32_t>(count);
+    return dot;
+}
+
+float sparseDot(const float* dense, const float* presence, const CenteredSpan& raters, std::uint32_t& common) {
+#if defined(__AVX2__)
+    __m256 dots = _mm256_setzero_ps();
+    __m256 counts = _mm256_setzero_ps();
+    float dot = 0.0f;
+    float count = 0.0f;
+    std::size_t i = 0;
+    for (std::size_t k = 0; k < raters.runCount; ++k) {
+        const RepeatedRun& run = raters.runs[k];
+        accumulateAvx2(dense, presence, raters, i, run.position, dots, counts, dot, count);
+        dot += dense[raters.users[run.position]] * run.dev;
+        count += presence[raters.users[run.position]];
+        i = run.position + run.count;
+    }
+    accumulateAvx2(dense, presence, raters, i, raters.size, dots, counts, dot, count);
+
+    alignas(32) float laneDots[8];
+    alignas(32) float laneCounts[8];
+    _mm256_store_ps(laneDots, dots);
+    _mm256_store_ps(laneCounts, counts);
+    for (int lane = 0; lane < 8; ++lane) {
+        dot += laneDots[lane];
+        count += laneCounts[lane];
+    }
+    common = static_cast<std::uint32_t>(count);
+    return dot;
+#else
+    return sparseDotScalar(dense, presence, raters, common);
+#endif
+}
+
+std::vector<Match> mostSimilar(const MovieRatings& byMovie, const CenteredRatings& centered,
+                               const MovieStore& movies, int movie, std::size_t n, unsigned threads) {
+    std::vector<Match> result;
+    float targetNorm = centered.norm(movie);
+    if (n == 0 || targetNorm == 0.0f) return result;
+
+    // Vetor do filme espalhado por usuário
+    std::vector<float> dense(centered.userCount(), 0.0f);
+    std::vector<float> presence(centered.userCount(), 0.0f);
+    centered.raters(byMovie, movie).forEach([&](int user, float dev) {
+        dense[user] = dev;
+        presence[user] = 1.0f;
+    });
+
+    CloserMatch closer{&movies};
+    int movieCount = static_cast<int>(centered.movieCount());
+
+    std::size_t workers = threads == 0 ? 1 : threads;
+    if (workers == 1 || centered.entryCount() < kMinParallelEntries) {
+        scoreRange(byMovie, centered, dense.data(), presence.data(), movie, targetNorm, 0, movieCount, n, closer, result);
+        return result;
+    }
+
+    // Blocos de candidatos com quantidades parecidas de avaliações; cada bloco guarda os seus
+    // n melhores e a junção fica com os n melhores de todos
+    std::size_t perBlock = centered.entryCount() / (workers * 4) + 1;
+    std::vector<int> bounds{0};
+    std::size_t filled = 0;
+    for (int c = 0; c < movieCount; ++c) {
+        filled += centered.raters(byMovie, c).size;
+        if (filled >= perBlock) {
+            bounds.push_back(c + 1);
+            filled = 0;
+        }
+    }
+    if (bounds.back() != movieCount) bounds.push_back(movieCount);
+
+    std::vector<std::vector<Match>> partials(bounds.size() - 1);
+    {
+        ThreadPool pool(workers);
+        for (std::size_t b = 0; b + 1 < bounds.size(); ++b) {
+            pool.submit([&, b] {
+                scoreRange(byMovie, centered, dense.data(), presence.data(), movie, targetNorm,
+                           bounds[b], bounds[b + 1], n, closer, partials[b]);
+            });
+        }
+        pool.wait();
+    }
+
+    for (const std::vector<Match>& part : partials) {
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    sort_utils::selectTop(result, n, closer);
+    return result;
+}
+
+} // namespace similarity
@@ -0,0 +1,525 @@
+#include "snapshot.hpp"
+#include "mapped_file.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+
+namespace {
+
+const char kMagic[8] = {'M', 'V', 'S', 'N', 'A', 'P', '\0', '\0'};
+const std::uint32_t kVersion = 4;
+
+// Tamanho e mtime de um CSV de origem (zerados se o arquivo não existir)
+struct SourceStamp {
+    std::uint64_t size = 0;
+    std::int64_t mtimeSec = 0;
+    std::int64_t mtimeNsec = 0;
+};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t payloadSize;
+    std::uint64_t checksum;
+    SourceStamp stamps[3];
+};
+
+SourceStamp stampOf(const std::string& path) {
+    SourceStamp stamp;
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0) {
+        stamp.size = static_cast<std::uint64_t>(st.st_size);
+        stamp.mtimeSec = static_cast<std::int64_t>(st.st_mtim.tv_sec);
+        stamp.mtimeNsec = static_cast<std::int64_t>(st.st_mtim.tv_nsec);
+    }
+    return stamp;
+}
+
+bool sameStamp(const SourceStamp& a, const SourceStamp& b) {
+    return a.size == b.size && a.mtimeSec == b.mtimeSec && a.mtimeNsec == b.mtimeNsec;
+}
+
+// Checksum de 64 bits processando 8 bytes por vez (variação do FNV-1a por palavra)
+class Checksum {
+public:
+    void update(const char* data, std::size_t len) {
+        std::size_t i = 0;
+        if (filled == 0) {
+            // caminho rápido: palavras inteiras de 8 bytes
+            for (; i + 8 <= len; i += 8) {
+                std::uint64_t word;
+                std::memcpy(&word, data + i, sizeof(word));
+                mix(word);
+            }
+        }
+        for (; i < len; ++i) {
+            pending |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[i])) << (8 * filled);
+            if (++filled == 8) {
+                mix(pending);
+                pending = 0;
+                filled = 0;
+            }
+        }
+    }
+
+    std::uint64_t finish() {
+        if (filled > 0) {
+            mix(pending);
+        }
+        return h ^ (h >> 29);
+    }
+
+private:
+    std::uint64_t h = 14695981039346656037ULL;
+    std::uint64_t pending = 0;
+    unsigned filled = 0;
+
+    void mix(std::uint64_t word) {
+        h ^= word;
+        h *= 1099511628211ULL;
+        h ^= h >> 32;
+    }
+};
+
+// Escreve o conteúdo no arquivo calculando o checksum ao mesmo tempo
+class PayloadWriter {
+public:
+    explicit PayloadWriter(std::ofstream& out) : out(out) {}
+
+    template <typename T>
+    void put(const T& value) {
+        bytes(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void array(const std::vector<T>& values) {
+        bytes(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    void bytes(const char* data, std::size_t len) {
+        out.write(data, static_cast<std::streamsize>(len));
+        sum.update(data, len);
+        written += len;
+    }
+
+    std::uint64_t size() const { return written; }
+    std::uint64_t checksum() { return sum.finish(); }
+
+private:
+    std::ofstream& out;
+    Checksum sum;
+    std::uint64_t written = 0;
+};
+
+// Leitura sequencial do conteúdo mapeado, sempre checando os limites
+class PayloadReader {
+public:
+    PayloadReader(const char* data, std::size_t size) : cur(data), end(data + size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (static_cast<std::size_t>(end - cur) < sizeof(T)) return false;
+        std::memcpy(&value, cur, sizeof(T));
+        cur += sizeof(T);
+        return true;
+    }
+
+    // Devolve um ponteiro para count elementos de T dentro do buffer mapeado
+    bool span(std::uint64_t count, std::size_t elemSize, const char*& out) {
+        if (elemSize != 0 && count > static_cast<std::uint64_t>(end - cur) / elemSize) return false;
+        out = cur;
+        cur += count * elemSize;
+        return true;
+    }
+
+    bool atEnd() const { return cur == end; }
+
+private:
+    const char* cur;
+    const char* end;
+};
+
+template <typename T>
+T at(const char* base, std::uint64_t i) {
+    T value;
+    std::memcpy(&value, base + i * sizeof(T), sizeof(T));
+    return value;
+}
+
+// Cópia de count elementos de T do buffer mapeado (que pode estar desalinhado)
+template <typename T>
+std::vector<T> copyArray(const char* base, std::uint64_t count) {
+    std::vector<T> values(count);
+    if (count > 0) {
+        std::memcpy(values.data(), base, count * sizeof(T));
+    }
+    return values;
+}
+
+// Offsets de uma seção CSR: precisam começar em 0, ser crescentes e terminar em total
+bool validOffsets(const char* offsets, std::uint64_t count, std::uint64_t total) {
+    if (at<std::uint64_t>(offsets, 0) != 0) return false;
+    for (std::uint64_t i = 0; i < count; ++i) {
+        if (at<std::uint64_t>(offsets, i + 1) < at<std::uint64_t>(offsets, i)) return false;
+    }
+    return at<std::uint64_t>(offsets, count) == total;
+}
+
+// Seções lidas do arquivo, ainda apontando para o buffer mapeado
+struct Sections {
+    std::uint64_t movieCount = 0;
+    const char* movieIds = nullptr;
+    const char* movieYears = nullptr;
+    const char* movieRatingCounts = nullptr;
+    const char* movieRatingSums = nullptr;
+    const char* titleOffsets = nullptr;
+    const char* genresOffsets = nullptr;
+    const char* movieText = nullptr;
+
+    std::uint64_t userCount = 0;
+    std::uint64_t ratingCount = 0;
+    std::uint64_t exactCount = 0;
+    const char* userIds = nullptr;
+    const char* ratingOffsets = nullptr;
+    const char* ratingMovies = nullptr;
+    const char* ratingCodes = nullptr;
+    const char* ratingExact = nullptr;
+
+    std::uint64_t tagCount = 0;
+    const char* tagKeyOffsets = nullptr;
+    const char* tagText = nullptr;
+    const char* tagListOffsets = nullptr;
+    const char* tagMovieIds = nullptr;
+
+    std::uint64_t neighborK = 0;
+    std::uint64_t neighborPairs = 0;
+    const char* neighborOffsets = nullptr;
+    const char* neighborMovies = nullptr;
+    const char* neighborSims = nullptr;
+};
+
+bool readSections(PayloadReader& in, Sections& s) {
+    // Filmes
+    std::uint64_t textSize = 0;
+    if (!in.get(s.movieCount) || !in.get(textSize)) return false;
+    if (!in.span(s.movieCount, sizeof(std::int32_t), s.movieIds)) return false;
+    if (!in.span(s.movieCount, sizeof(std::int32_t), s.movieYears)) return false;
+    if (!in.span(s.movieCount, sizeof(std::int32_t), s.movieRatingCounts)) return false;
+    if (!in.span(s.movieCount, sizeof(double), s.movieRatingSums)) return false;
+    if (!in.span(s.movieCount + 1, sizeof(std::uint64_t), s.titleOffsets)) return false;
+    if (!in.span(s.movieCount + 1, sizeof(std::uint64_t), s.genresOffsets)) return false;
+    if (!in.span(textSize, 1, s.movieText)) return false;
+    // títulos e gêneros dividem o mesmo bloco de texto: títulos primeiro, depois gêneros
+    std::uint64_t titlesEnd = at<std::uint64_t>(s.titleOffsets, s.movieCount);
+    if (titlesEnd > textSize) return false;
+    if (!validOffsets(s.titleOffsets, s.movieCount, titlesEnd)) return false;
+    if (at<std::uint64_t>(s.genresOffsets, 0) != titlesEnd) return false;
+    for (std::uint64_t i = 0; i < s.movieCount; ++i) {
+        if (at<std::uint64_t>(s.genresOffsets, i + 1) < at<std::uint64_t>(s.genresOffsets, i)) return false;
+    }
+    if (at<std::uint64_t>(s.genresOffsets, s.movieCount) != textSize) return false;
+
+    // Usuários: o CSR do UserStore como está na memória. Os filmes são índices densos, que
+    // coincidem com a ordem da seção de filmes. As notas vêm em meias estrelas (1 byte) ou,
+    // se exactCount == ratingCount, em float.
+    if (!in.get(s.userCount) || !in.get(s.ratingCount) || !in.get(s.exactCount)) return false;
+    if (s.exactCount != 0 && s.exactCount != s.ratingCount) return false;
+    std::uint64_t codeCount = s.exactCount == 0 ? s.ratingCount : 0;
+    if (!in.span(s.userCount, sizeof(std::int32_t), s.userIds)) return false;
+    if (!in.span(s.userCount + 1, sizeof(std::uint64_t), s.ratingOffsets)) return false;
+    if (!in.span(s.ratingCount, sizeof(std::int32_t), s.ratingMovies)) return false;
+    if (!in.span(codeCount, 1, s.ratingCodes)) return false;
+    if (!in.span(s.exactCount, sizeof(float), s.ratingExact)) return false;
+    if (!validOffsets(s.ratingOffsets, s.userCount, s.ratingCount)) return false;
+    for (std::uint64_t r = 0; r < s.ratingCount; ++r) {
+        std::int32_t movie = at<std::int32_t>(s.ratingMovies, r);
+        if (movie < 0 || static_cast<std::uint64_t>(movie) >= s.movieCount) return false;
+    }
+
+    // Tags
+    std::uint64_t tagTextSize = 0;
+    std::uint64_t tagMovieCount = 0;
+    if (!in.get(s.tagCount) || !in.get(tagTextSize) || !in.get(tagMovieCount)) return false;
+    if (!in.span(s.tagCount + 1, sizeof(std::uint64_t), s.tagKeyOffsets)) return false;
+    if (!in.span(tagTextSize, 1, s.tagText)) return false;
+    if (!in.span(s.tagCount + 1, sizeof(std::uint64_t), s.tagListOffsets)) return false;
+    if (!in.span(tagMovieCount, sizeof(std::int32_t), s.tagMovieIds)) return false;
+    if (!validOffsets(s.tagKeyOffsets, s.tagCount, tagTextSize)) return false;
+    if (!validOffsets(s.tagListOffsets, s.tagCount, tagMovieCount)) return false;
+
+    // Vizinhos item-item (k = 0 se a tabela não foi montada): índices densos de filmes
+    if (!in.get(s.neighborK) || !in.get(s.neighborPairs)) return false;
+    if (s.neighborK == 0) {
+        if (s.neighborPairs != 0) return false;
+    } else {
+        // a tabela na memória usa offsets de 32 bits
+        if (s.neighborPairs > UINT32_MAX) return false;
+        if (!in.span(s.movieCount + 1, sizeof(std::uint64_t), s.neighborOffsets)) return false;
+        if (!in.span(s.neighborPairs, sizeof(std::int32_t), s.neighborMovies)) return false;
+        if (!in.span(s.neighborPairs, sizeof(float), s.neighborSims)) return false;
+        if (!validOffsets(s.neighborOffsets, s.movieCount, s.neighborPairs)) return false;
+        for (std::uint64_t m = 0; m < s.movieCount; ++m) {
+            if (at<std::uint64_t>(s.neighborOffsets, m + 1) - at<std::uint64_t>(s.neighborOffsets, m) > s.neighborK) {
+                return false;
+            }
+        }
+        for (std::uint64_t p = 0; p < s.neighborPairs; ++p) {
+            std::int32_t movie = at<std::int32_t>(s.neighborMovies, p);
+            if (movie < 0 || static_cast<std::uint64_t>(movie) >= s.movieCount) return false;
+        }
+    }
+
+    return in.atEnd();
+}
+
+} // namespace
+
+namespace snapshot {
+
+bool write(const std::string& path, const DataContext& ctx, const Sources& sources, std::string& error) {
+    // Grava em um arquivo temporário e renomeia no fim, para nunca deixar um snapshot pela metade
+    std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        error = "cannot open " + tmpPath;
+        return false;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.stamps[0] = stampOf(sources.movies);
+    header.stamps[1] = stampOf(sources.ratings);
+    header.stamps[2] = stampOf(sources.tags);
+
+    // Cabeçalho provisório; é reescrito com tamanho e checksum no final
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    PayloadWriter w(out);
+
+    // ---------------- FILMES ----------------
+    std::vector<std::int32_t> ids, years, counts;
+    std::vector<double> sums;
+    std::vector<std::uint64_t> titleOffsets{0}, genresOffsets;
+    std::string text;
+
+    const MovieStore& movies = ctx.movies;
+    for (std::size_t i = 0; i < movies.size(); ++i) {
+        int idx = static_cast<int>(i);
+        ids.push_back(movies.movieId(idx));
+        years.push_back(movies.year(idx));
+        counts.push_back(movies.ratingCount(idx));
+        sums.push_back(movies.ratingSum(idx));
+        text += movies.title(idx);
+        titleOffsets.push_back(text.size());
+    }
+    genresOffsets.push_back(text.size());
+    for (std::size_t i = 0; i < movies.size(); ++i) {
+        text += movies.genres(static_cast<int>(i));
+        genresOffsets.push_back(text.size());
+    }
+
+    w.put(static_cast<std::uint64_t>(ids.size()));
+    w.put(static_cast<std::uint64_t>(text.size()));
+    w.array(ids);
+    w.array(years);
+    w.array(counts);
+    w.array(sums);
+    w.array(titleOffsets);
+    w.array(genresOffsets);
+    w.bytes(text.data(), text.size());
+
+    // ---------------- USUÁRIOS ----------------
+    // Os filmes já são índices densos na mesma ordem da seção de filmes
+    const UserStore& users = ctx.users;
+    std::vector<std::int32_t> userIds;
+    for (std::size_t u = 0; u < users.size(); ++u) {
+        userIds.push_back(users.userId(static_cast<int>(u)));
+    }
+
+    w.put(static_cast<std::uint64_t>(users.size()));
+    w.put(static_cast<std::uint64_t>(users.ratingCount()));
+    w.put(static_cast<std::uint64_t>(users.exactColumn().size()));
+    w.array(userIds);
+    w.array(users.offsetColumn());
+    w.array(users.movieColumn());
+    w.array(users.codeColumn());
+    w.array(users.exactColumn());
+
+    // ---------------- TAGS ----------------
+    std::vector<std::uint64_t> keyOffsets{0}, listOffsets{0};
+    std::vector<std::int32_t> tagMovieIds;
+    std::string tagText;
+    std::vector<int> tagList;
+    ctx.tags.forEach([&](std::string_view tag, const TagEntry& entry) {
+        tagText += tag;
+        keyOffsets.push_back(tagText.size());
+        // Tags com bitmap não têm mais a lista inteira; o snapshot guarda sempre a lista
+        ctx.tags.movieIdsOf(entry, ctx.denseMovieIds, tagList);
+        tagMovieIds.insert(tagMovieIds.end(), tagList.begin(), tagList.end());
+        listOffsets.push_back(tagMovieIds.size());
+    });
+
+    w.put(static_cast<std::uint64_t>(keyOffsets.size() - 1));
+    w.put(static_cast<std::uint64_t>(tagText.size()));
+    w.put(static_cast<std::uint64_t>(tagMovieIds.size()));
+    w.array(keyOffsets);
+    w.bytes(tagText.data(), tagText.size());
+    w.array(listOffsets);
+    w.array(tagMovieIds);
+
+    // ---------------- VIZINHOS ----------------
+    const ItemNeighbors& neighbors = ctx.neighbors;
+    w.put(static_cast<std::uint64_t>(neighbors.neighborsPerMovie()));
+    w.put(static_cast<std::uint64_t>(neighbors.pairCount()));
+    if (neighbors.neighborsPerMovie() > 0) {
+        std::vector<std::uint64_t> neighborOffsets(neighbors.offsetColumn().begin(), neighbors.offsetColumn().end());
+        w.array(neighborOffsets);
+        w.array(neighbors.movieColumn());
+        w.array(neighbors.simColumn());
+    }
+
+    header.payloadSize = w.size();
+    header.checksum = w.checksum();
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+
+    if (!out) {
+        error = "write failed on " + tmpPath;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        error = "cannot rename " + tmpPath + " to " + path;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool load(const std::string& path, DataContext& ctx, const Sources& sources, std::string& error) {
+    MappedFile file(path);
+    if (!file.isOpen()) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    Header header;
+    if (file.size() < sizeof(header)) {
+        error = "truncated snapshot";
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        error = "not a snapshot file";
+        return false;
+    }
+    if (header.version != kVersion) {
+        error = "snapshot version " + std::to_string(header.version) +
+                ", expected " + std::to_string(kVersion);
+        return false;
+    }
+    if (header.payloadSize != file.size() - sizeof(header)) {
+        error = "truncated snapshot";
+        return false;
+    }
+    if (!sameStamp(header.stamps[0], stampOf(sources.movies)) ||
+        !sameStamp(header.stamps[1], stampOf(sources.ratings)) ||
+        !sameStamp(header.stamps[2], stampOf(sources.tags))) {
+        error = "snapshot is stale (source CSVs changed)";
+        return false;
+    }
+
+    const char* payload = file.data() + sizeof(header);
+    Checksum sum;
+    sum.update(payload, header.payloadSize);
+    if (sum.finish() != header.checksum) {
+        error = "checksum mismatch";
+        return false;
+    }
+
+    Sections s;
+    PayloadReader in(payload, header.payloadSize);
+    if (!readSections(in, s)) {
+        error = "malformed snapshot";
+        return false;
+    }
+
+    // O CSR dos usuários é copiado como está; só falta conferir userIds repetidos
+    UserStore users;
+    if (!users.assign(copyArray<int>(s.userIds, s.userCount),
+                      copyArray<std::uint64_t>(s.ratingOffsets, s.userCount + 1),
+                      copyArray<std::int32_t>(s.ratingMovies, s.ratingCount),
+                      copyArray<std::uint8_t>(s.ratingCodes, s.exactCount == 0 ? s.ratingCount : 0),
+                      copyArray<float>(s.ratingExact, s.exactCount))) {
+        error = "malformed snapshot";
+        return false;
+    }
+
+    // A partir daqui o arquivo é válido: remonta as estruturas
+    ctx.movies = MovieStore(s.movieCount);
+    ctx.users = std::move(users);
+    ctx.tags = TagHashTable(s.tagCount);
+    ctx.neighbors = ItemNeighbors();
+
+    for (std::uint64_t i = 0; i < s.movieCount; ++i) {
+        int movieId = at<std::int32_t>(s.movieIds, i);
+        std::uint64_t titleBegin = at<std::uint64_t>(s.titleOffsets, i);
+        std::uint64_t titleEnd = at<std::uint64_t>(s.titleOffsets, i + 1);
+        std::uint64_t genresBegin = at<std::uint64_t>(s.genresOffsets, i);
+        std::uint64_t genresEnd = at<std::uint64_t>(s.genresOffsets, i + 1);
+
+        std::string title(s.movieText + titleBegin, titleEnd - titleBegin);
+        std::string_view genres(s.movieText + genresBegin, genresEnd - genresBegin);
+
+        int idx = ctx.movies.insertOrGet(movieId);
+        // Filmes criados só pelo ratings.csv ficam sem textos, como no carregamento dos CSVs
+        int year = at<std::int32_t>(s.movieYears, i);
+        if (!title.empty() || !genres.empty() || year != 0) {
+            ctx.movies.setInfo(idx, title, genres, year);
+        }
+        ctx.movies.addRatings(idx, at<std::int32_t>(s.movieRatingCounts, i), at<double>(s.movieRatingSums, i));
+
+        // Só os filmes do movies.csv têm título e entram na trie
+        if (!title.empty()) {
+            ctx.trie.insert(title, movieId);
+        }
+    }
+
+    for (std::uint64_t i = 0; i < s.tagCount; ++i) {
+        std::uint64_t keyBegin = at<std::uint64_t>(s.tagKeyOffsets, i);
+        std::uint64_t keyEnd = at<std::uint64_t>(s.tagKeyOffsets, i + 1);
+        std::uint64_t listBegin = at<std::uint64_t>(s.tagListOffsets, i);
+        std::uint64_t listEnd = at<std::uint64_t>(s.tagListOffsets, i + 1);
+
+        std::vector<int>& list = ctx.tags.insertOrGet(std::string_view(s.tagText + keyBegin, keyEnd - keyBegin));
+        list.reserve(listEnd - listBegin);
+        for (std::uint64_t r = listBegin; r < listEnd; ++r) {
+            list.push_back(at<std::int32_t>(s.tagMovieIds, r));
+        }
+    }
+
+    if (s.neighborK > 0) {
+        std::vector<std::uint32_t> neighborOffsets(s.movieCount + 1);
+        for (std::uint64_t m = 0; m <= s.movieCount; ++m) {
+            neighborOffsets[m] = static_cast<std::uint32_t>(at<std::uint64_t>(s.neighborOffsets, m));
+        }
+        ctx.neighbors.assign(s.neighborK, std::move(neighborOffsets),
+                             copyArray<std::int32_t>(s.neighborMovies, s.neighborPairs),
+                             copyArray<float>(s.neighborSims, s.neighborPairs));
+    }
+
+    return true;
+}
+
+} // namespace snapshot
@@ -0,0 +1,33 @@
+#include "string_arena.hpp"
+
+StringRef StringArena::append(std::string_view s) {
+    StringRef ref;
+    ref.offset = static_cast<std::uint32_t>(text.size());
+    ref.length = static_cast<std::uint32_t>(s.size());
+    text.append(s.data(), s.size());
+    return ref;
+}
+
+StringRef StringArena::intern(std::string_view s) {
+    std::uint64_t h = hash_table::hashBytes(s.data(), s.size());
+
+    bool inserted = false;
+    StringRef& ref = interned.insertOrGet(h, inserted);
+    if (inserted) {
+        ref = append(s);
+        return ref;
+    }
+    if (view(ref) == s) {
+        return ref;
+    }
+    // Colisão de hash com outro texto: guarda uma cópia própria, sem internar
+    return append(s);
+}
+
+std::size_t StringArena::textSize() const {
+    return text.size();
+}
+
+std::size_t StringArena::memoryUsage() const {
+    return text.capacity() + interned.capacity() * (1 + sizeof(std::uint64_t) + sizeof(StringRef));
+}
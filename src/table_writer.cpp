@@ -0,0 +1,33 @@
+#include "table_writer.hpp"
+
+#include <cstdio>
+
+TableWriter::TableWriter(std::ostream& out, std::size_t flushBytes) : out(out), flushBytes(flushBytes) {
+    buffer.reserve(flushBytes + 256);
+}
+
+TableWriter::~TableWriter() {
+    flush();
+}
+
+TableWriter& TableWriter::fixed(double value, int precision, std::size_t width) {
+    // Cabe qualquer double finito com até 17 casas; valores maiores vão pelo snprintf
+    char digits[352];
+    std::to_chars_result r = std::to_chars(digits, digits + sizeof(digits), value,
+                                           std::chars_format::fixed, precision);
+    std::size_t length;
+    if (r.ec == std::errc()) {
+        length = static_cast<std::size_t>(r.ptr - digits);
+    } else {
+        int n = std::snprintf(digits, sizeof(digits), "%.*f", precision, value);
+        length = n < 0 ? 0 : static_cast<std::size_t>(n);
+        if (length >= sizeof(digits)) length = sizeof(digits) - 1;
+    }
+    return right(std::string_view(digits, length), width);
+}
+
+void TableWriter::flush() {
+    if (buffer.empty()) return;
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
@@ -1,88 +1,144 @@
 #include "tags.hpp"
+#include "sort_utils.hpp"
 #include <cstddef>
-#include <stdexcept>
 
-TagHashTable::TagHashTable(std::size_t capacity) : table(), count(0) {
-    std::size_t cap = capacity == 0 ? 1 : capacity;
-    table.resize(cap);
+TagHashTable::TagHashTable(std::size_t expected) : text(), table(expected), bitmaps() {}
+
+void TagHashTable::addMovie(std::string_view tag, int movieId) {
+    // Duplicatas são removidas depois, em finalize()
+    insertOrGet(tag).push_back(movieId);
 }
 
-// Hash de string: combina valores ASCII dos caracteres
-std::size_t TagHashTable::hash(const std::string& s) const {
-    // multiplicative string hash
-    std::size_t h = 0;
-    const std::size_t base = 131;
-    for (unsigned char c : s) {
-        h = h * base + c;
-    }
-    return h % table.size();
+// Retorna a lista de filmes da tag, criando uma lista vazia se a tag ainda não existir.
+// Só uma tag nova tem o texto copiado para a arena.
+std::vector<int>& TagHashTable::insertOrGet(std::string_view tag) {
+    if (TagEntry* entry = table.find(tag)) return entry->movieIds;
+    bool inserted = false;
+    return table.insertOrGet(text.copy(tag), inserted).movieIds;
 }
 
-// Sondagem linear
-std::size_t TagHashTable::probe(std::size_t index, std::size_t step) const {
-    return (index + step) % table.size();
+// Entrada da tag, ou nullptr se a tag não existir. Sem bitmap, entry->movieIds é a lista
+// ordenada e sem duplicatas; com bitmap, os filmes do catálogo estão em bitmapAt(entry->bitmap).
+const TagEntry* TagHashTable::find(std::string_view tag) const {
+    return table.find(tag);
 }
 
-void TagHashTable::addMovie(const std::string& tag, int movieId) {
-    if (table.empty()) return;
+void TagHashTable::movieIdsOf(const TagEntry& entry, const std::vector<int>& denseMovieIds,
+                              std::vector<int>& out) const {
+    out.clear();
+    if (entry.bitmap < 0) {
+        out = entry.movieIds;
+        return;
+    }
 
-    std::size_t h = hash(tag);
+    // Junta os ids do bitmap (crescentes, como os índices densos) com os de fora do catálogo
+    std::vector<std::uint32_t> dense;
+    bitmaps[entry.bitmap].toVector(dense);
+    out.reserve(dense.size() + entry.movieIds.size());
+    std::size_t extra = 0;
+    for (std::uint32_t d : dense) {
+        int id = denseMovieIds[d];
+        while (extra < entry.movieIds.size() && entry.movieIds[extra] < id) out.push_back(entry.movieIds[extra++]);
+        out.push_back(id);
+    }
+    while (extra < entry.movieIds.size()) out.push_back(entry.movieIds[extra++]);
+}
 
-    for (std::size_t step = 0; step < table.size(); ++step) {
-        std::size_t idx = probe(h, step);
-        TagHashEntry& entry = table[idx];
+std::size_t TagHashTable::movieCount(const TagEntry& entry) const {
+    std::size_t count = entry.movieIds.size();
+    if (entry.bitmap >= 0) count += bitmaps[entry.bitmap].cardinality();
+    return count;
+}
 
-        if (entry.occupied) {
-            // Slot ocupado: se for a mesma tag (e não marcada como deletada), atualiza a lista de filmes
-            if (!entry.deleted && entry.key == tag) {
-                bool exists = false;
-                for (int id : entry.movieIds) {
-                    if (id == movieId) {
-                        exists = true;
-                        break;
-                    }
-                }
-                if (!exists) {
-                    entry.movieIds.push_back(movieId);
-                }
-                return;
-            }
-            // Caso contrário, continua sondando
-        } else {
-            // Slot vazio: insere nova tag aqui
-            entry.key = tag;
-            entry.movieIds.clear();
-            entry.movieIds.push_back(movieId);
-            entry.occupied = true;
-            entry.deleted  = false;
-            ++count;
-            return;
+RoaringBitmap TagHashTable::bitmapOf(std::string_view tag, const std::vector<int>& denseMovieIds) const {
+    const TagEntry* entry = table.find(tag);
+    if (!entry) return RoaringBitmap();
+    if (entry->bitmap >= 0) return bitmaps[entry->bitmap];
+    return denseBitmap(entry->movieIds, denseMovieIds);
+}
+
+// As duas listas estão ordenadas: converte movieId -> índice denso em uma passada.
+// Ids que não estão no catálogo de filmes ficam de fora (e vão para missing, se pedido).
+RoaringBitmap TagHashTable::denseBitmap(const std::vector<int>& movieIds, const std::vector<int>& denseMovieIds,
+                                        std::vector<int>* missing) {
+    std::vector<std::uint32_t> dense;
+    dense.reserve(movieIds.size());
+
+    std::size_t pos = 0;
+    for (int id : movieIds) {
+        while (pos < denseMovieIds.size() && denseMovieIds[pos] < id) ++pos;
+        if (pos < denseMovieIds.size() && denseMovieIds[pos] == id) {
+            dense.push_back(static_cast<std::uint32_t>(pos));
+        } else if (missing) {
+            missing->push_back(id);
         }
     }
+    return RoaringBitmap::fromSorted(dense);
+}
+
+// Ordena a lista de filmes de cada tag e remove as duplicatas. Chamado uma vez
+// depois do carregamento; as interseções em queryTags dependem das listas ordenadas.
+void TagHashTable::finalize() {
+    table.forEach([](std::string_view, TagEntry& entry) {
+        std::vector<int>& ids = entry.movieIds;
+        sort_utils::quickSort(ids, [](int a, int b) { return a < b; });
 
-    // Se chegou aqui, tabela cheia (situação anômala)
-    throw std::runtime_error("TagHashTable::addMovie – Hash table full");
+        std::size_t unique = 0;
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            if (unique == 0 || ids[i] != ids[unique - 1]) {
+                ids[unique++] = ids[i];
+            }
+        }
+        ids.resize(unique);
+        ids.shrink_to_fit();
+    });
 }
 
-std::vector<int> TagHashTable::getMovies(const std::string& tag) const {
-    if (table.empty()) return {};
+// A lista de uma tag com bitmap é trocada pelos ids que ficaram fora do bitmap, então cada
+// filme fica guardado uma vez só (o bitmap ocupa bem menos que a lista de int)
+void TagHashTable::buildBitmaps(const std::vector<int>& denseMovieIds, std::size_t minSize) {
+    table.forEach([&](std::string_view, TagEntry& entry) {
+        if (entry.bitmap >= 0 || entry.movieIds.size() < minSize) return;
 
-    std::size_t h = hash(tag);
+        std::vector<int> missing;
+        entry.bitmap = static_cast<std::int32_t>(bitmaps.size());
+        bitmaps.push_back(denseBitmap(entry.movieIds, denseMovieIds, &missing));
+        entry.movieIds.swap(missing);
+    });
+}
 
-    for (std::size_t step = 0; step < table.size(); ++step) {
-        std::size_t idx = probe(h, step);
-        const TagHashEntry& entry = table[idx];
+std::size_t TagHashTable::listMemoryUsage() const {
+    std::size_t total = 0;
+    table.forEach([&total](std::string_view, const TagEntry& entry) {
+        total += sizeof(entry.movieIds) + entry.movieIds.capacity() * sizeof(int);
+    });
+    return total;
+}
 
-        if (!entry.occupied && !entry.deleted) {
-            // Slot nunca usado → tag não existe
-            return {};
-        }
+std::size_t TagHashTable::textMemoryUsage() const {
+    return text.memoryUsage();
+}
 
-        if (entry.occupied && !entry.deleted && entry.key == tag) {
-            return entry.movieIds;
-        }
-        // Senão continua sondando
+std::size_t TagHashTable::bitmapMemoryUsage() const {
+    std::size_t total = bitmaps.capacity() * sizeof(RoaringBitmap);
+    for (const RoaringBitmap& b : bitmaps) {
+        total += b.memoryUsage();
     }
+    return total;
+}
+
+void TagHashTable::reserve(std::size_t n) {
+    table.reserve(n);
+}
+
+std::size_t TagHashTable::size() const {
+    return table.size();
+}
+
+std::size_t TagHashTable::capacity() const {
+    return table.capacity();
+}
 
-    return {};
+std::size_t TagHashTable::maxProbeLength() const {
+    return table.maxProbeLength();
 }
@@ -0,0 +1,64 @@
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(std::size_t threads) : pending(0), stopping(false) {
+    std::size_t n = threads == 0 ? 1 : threads;
+    workers.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    taskReady.notify_all();
+    for (auto& w : workers) {
+        w.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        tasks.push_back(std::move(task));
+        ++pending;
+    }
+    taskReady.notify_one();
+}
+
+// Bloqueia até que todas as tarefas enviadas tenham terminado
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mtx);
+    allDone.wait(lock, [this] { return pending == 0; });
+}
+
+std::size_t ThreadPool::size() const {
+    return workers.size();
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            taskReady.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            --pending;
+            if (pending == 0) {
+                allDone.notify_all();
+            }
+        }
+    }
+}
@@ -1,88 +1,412 @@
 #include "trie.hpp"
+#include "arena.hpp"
+#include "sort_utils.hpp"
+#include <algorithm>
 
-//Inicializa children com nullptr e isTerminal = false
-TrieNode::TrieNode() : isTerminal(false), movieIds() {
-    for (int i = 0; i < 128; ++i) {
-        children[i] = nullptr;
-    }
+namespace {
+
+char lowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
 }
 
-//Inicializa a raiz da TRIE como um nodo
+} // namespace
+
+//Inicializa a raiz da TRIE como um nodo sem rótulo
 TitleTrie::TitleTrie() {
-    root = new TrieNode();
+    newNode(0, 0);
 }
 
-TitleTrie::~TitleTrie() {
-    freeNode(root);
+int TitleTrie::newNode(std::uint32_t labelOffset, std::uint32_t labelLength) {
+    TrieNode node;
+    node.labelOffset = labelOffset;
+    node.labelLength = labelLength;
+    nodes.push_back(node);
+    return static_cast<int>(nodes.size()) - 1;
 }
 
-void TitleTrie::insert(const std::string& title, int movieId) {
-    TrieNode* current = root;
-
+void TitleTrie::insert(std::string_view title, int movieId) {
+    // Assumindo apenas ASCII como especificado: caracteres fora de ASCII são ignorados.
+    // Quase todo título já é ASCII e é usado direto; os outros são filtrados em asciiScratch.
+    std::string_view key = title;
     for (char ch : title) {
-        unsigned char index = static_cast<unsigned char>(ch);
-        if (index >= 128) {
-            // Assumindo apenas ASCII como especificado.
-            continue;
+        if (static_cast<unsigned char>(ch) >= 128) {
+            asciiScratch.clear();
+            for (char c : title) {
+                if (static_cast<unsigned char>(c) < 128) asciiScratch.push_back(c);
+            }
+            key = asciiScratch;
+            break;
+        }
+    }
+
+    int current = 0;
+    std::size_t pos = 0;
+
+    while (pos < key.size()) {
+        // Procura o filho cujo rótulo começa com key[pos], guardando o anterior
+        // para manter a lista de irmãos ordenada
+        int prev = -1;
+        int child = nodes[current].firstChild;
+        while (child != -1 && labels[nodes[child].labelOffset] < key[pos]) {
+            prev = child;
+            child = nodes[child].nextSibling;
+        }
+
+        if (child == -1 || labels[nodes[child].labelOffset] != key[pos]) {
+            // Nenhuma aresta começa com esse caractere: cria uma folha com o resto do título
+            int leaf = newNode(static_cast<std::uint32_t>(labels.size()),
+                               static_cast<std::uint32_t>(key.size() - pos));
+            labels.append(key.substr(pos));
+
+            nodes[leaf].nextSibling = child;
+            if (prev == -1) {
+                nodes[current].firstChild = leaf;
+            } else {
+                nodes[prev].nextSibling = leaf;
+            }
+            current = leaf;
+            pos = key.size();
+            break;
+        }
+
+        // Quantos caracteres do rótulo coincidem com o restante do título
+        std::uint32_t common = 0;
+        const TrieNode& c = nodes[child];
+        while (common < c.labelLength && pos + common < key.size() &&
+               labels[c.labelOffset + common] == key[pos + common]) {
+            ++common;
         }
 
-        if (current->children[index] == nullptr) {
-            current->children[index] = new TrieNode();
+        if (common < nodes[child].labelLength) {
+            // Divide a aresta: o nó intermediário fica com o trecho comum
+            // e o filho antigo passa a começar logo depois dele
+            int mid = newNode(nodes[child].labelOffset, common);
+            nodes[mid].nextSibling = nodes[child].nextSibling;
+            nodes[mid].firstChild = child;
+            if (prev == -1) {
+                nodes[current].firstChild = mid;
+            } else {
+                nodes[prev].nextSibling = mid;
+            }
+
+            nodes[child].labelOffset += common;
+            nodes[child].labelLength -= common;
+            nodes[child].nextSibling = -1;
+            child = mid;
         }
-        current = current->children[index];
+
+        current = child;
+        pos += common;
     }
 
-    current->isTerminal = true;
-    current->movieIds.push_back(movieId);
+    // Adiciona o movieId ao fim da lista do nó terminal
+    ids.push_back(movieId);
+    idNext.push_back(-1);
+    int idIndex = static_cast<int>(ids.size()) - 1;
+    if (nodes[current].lastId == -1) {
+        nodes[current].firstId = idIndex;
+    } else {
+        idNext[nodes[current].lastId] = idIndex;
+    }
+    nodes[current].lastId = idIndex;
 }
 
-std::vector<int> TitleTrie::searchPrefix(const std::string& prefix) const {
-    std::vector<int> result;
-    const TrieNode* current = root;
+// Nó onde termina o prefixo (o prefixo pode terminar no meio de um rótulo; nesse
+// caso é o nó no fim da aresta). Retorna -1 se nenhum título tiver esse prefixo.
+int TitleTrie::findPrefixNode(const std::string& prefix) const {
+    int current = 0;
+    std::size_t pos = 0;
 
-    for (char ch : prefix) {
-        unsigned char index = static_cast<unsigned char>(ch);
+    while (pos < prefix.size()) {
+        unsigned char index = static_cast<unsigned char>(prefix[pos]);
         if (index >= 128) {
             // Prefixo com caractere fora de ASCII: não encontra nada.
-            return {};
+            return -1;
+        }
+
+        int child = nodes[current].firstChild;
+        while (child != -1 && labels[nodes[child].labelOffset] != prefix[pos]) {
+            child = nodes[child].nextSibling;
+        }
+        if (child == -1) {
+            return -1;
         }
 
-        if (current->children[index] == nullptr) {
-            return {};
+        const TrieNode& c = nodes[child];
+        for (std::uint32_t i = 0; i < c.labelLength && pos < prefix.size(); ++i, ++pos) {
+            if (static_cast<unsigned char>(prefix[pos]) >= 128) {
+                return -1;
+            }
+            if (labels[c.labelOffset + i] != prefix[pos]) {
+                return -1;
+            }
         }
-        current = current->children[index];
+        current = child;
     }
 
-    collect(const_cast<TrieNode*>(current), result);
+    return current;
+}
+
+std::vector<int> TitleTrie::searchPrefix(const std::string& prefix) const {
+    std::vector<int> result;
+    int node = findPrefixNode(prefix);
+    if (node == -1) {
+        return {};
+    }
+
+    collect(node, result);
     return result;
 }
 
-void TitleTrie::collect(TrieNode* node, std::vector<int>& out) const {
-    if (node == nullptr) {
-        return;
+int TitleTrie::rank(int movieId) const {
+    const int* r = rankOf.find(movieId);
+    return r ? *r : -1;
+}
+
+void TitleTrie::buildTopCache(const std::vector<int>& ranked, std::size_t k) {
+    rankOf = hash_table::OpenHashTable<int, int, hash_table::IntHash>(ranked.size());
+    topCache.clear();
+    rankedIds = ranked;
+    topK = k;
+
+    for (std::size_t r = 0; r < ranked.size(); ++r) {
+        bool inserted = false;
+        rankOf.insertOrGet(ranked[r], inserted) = static_cast<int>(r);
     }
 
-    if (node->isTerminal) {
-        out.insert(out.end(), node->movieIds.begin(), node->movieIds.end());
+    // Ordem de pré-ordem dos nós; percorrida de trás para frente, cada filho
+    // é processado antes do pai
+    std::vector<int> order;
+    order.reserve(nodes.size());
+    std::vector<int> stack{0};
+    while (!stack.empty()) {
+        int n = stack.back();
+        stack.pop_back();
+        order.push_back(n);
+        for (int c = nodes[n].firstChild; c != -1; c = nodes[c].nextSibling) {
+            stack.push_back(c);
+        }
     }
 
-    for (int i = 0; i < 128; ++i) {
-        if (node->children[i] != nullptr) {
-            collect(node->children[i], out);
+    // best[n] = ranks dos até k melhores filmes da subárvore de n, em ordem crescente.
+    // As listas ficam em uma arena local em vez de um vector por nó: a montagem faz
+    // algumas dezenas de alocações em vez de uma por nó, e tudo sai junto no fim da função.
+    struct RankList {
+        const int* data = nullptr;
+        std::size_t size = 0;
+    };
+    std::vector<RankList> best(nodes.size());
+    MonotonicArena scratch(std::size_t(1) << 16);
+    std::vector<int> merged;
+
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        int n = *it;
+        TrieNode& node = nodes[n];
+        merged.clear();
+
+        for (int id = node.firstId; id != -1; id = idNext[id]) {
+            int r = rank(ids[id]);
+            if (r != -1) merged.push_back(r);
+        }
+
+        bool hasMore = false;
+        for (int c = node.firstChild; c != -1; c = nodes[c].nextSibling) {
+            merged.insert(merged.end(), best[c].data, best[c].data + best[c].size);
+            // um filho com cache tem mais de k filmes, então este nó também tem
+            if (nodes[c].topBegin != -1) hasMore = true;
         }
+
+        if (merged.size() > k) hasMore = true;
+        sort_utils::selectTop(merged, k, [](int a, int b) { return a < b; });
+
+        node.topBegin = -1;
+        node.topCount = 0;
+        if (hasMore) {
+            node.topBegin = static_cast<std::int32_t>(topCache.size());
+            node.topCount = static_cast<std::int32_t>(k);
+            for (int r : merged) topCache.push_back(ranked[r]);
+        }
+        if (!merged.empty()) {
+            int* list = scratch.allocateArray<int>(merged.size());
+            std::copy(merged.begin(), merged.end(), list);
+            best[n] = RankList{list, merged.size()};
+        }
+    }
+}
+
+std::vector<int> TitleTrie::topByPrefix(const std::string& prefix, std::size_t n) const {
+    int node = findPrefixNode(prefix);
+    if (node == -1 || n == 0) {
+        return {};
     }
+
+    const TrieNode& found = nodes[node];
+    if (found.topBegin != -1 && n <= topK) {
+        return std::vector<int>(topCache.begin() + found.topBegin, topCache.begin() + found.topBegin + n);
+    }
+
+    // Sem cache (subárvore pequena) ou n maior que o cache: coleta e ordena pelo ranking
+    std::vector<int> all;
+    collect(node, all);
+
+    std::vector<int> ranks;
+    ranks.reserve(all.size());
+    for (int id : all) {
+        int r = rank(id);
+        if (r != -1) ranks.push_back(r);
+    }
+    sort_utils::selectTop(ranks, n, [](int a, int b) { return a < b; });
+
+    std::vector<int> result;
+    result.reserve(ranks.size());
+    for (std::size_t i = 0; i < ranks.size(); ++i) {
+        result.push_back(rankedIds[ranks[i]]);
+    }
+    return result;
 }
 
-void TitleTrie::freeNode(TrieNode* node) {
-    if (node == nullptr) {
-        return;
+// Busca aproximada: percorre a TRIE mantendo a linha da matriz de Levenshtein entre text e o
+// caminho da raiz até o caractere atual (linha[j] = distância entre text[0..j) e o caminho).
+// linha[m] é a distância de text ao título que termina ali; o menor valor da linha é um
+// limite inferior para qualquer caminho mais fundo. Quando esse limite já não pode melhorar
+// a melhor distância vista no caminho (ou passa de maxEdits), a descida para: a subárvore
+// inteira entra com a melhor distância, ou é descartada.
+std::vector<FuzzyMatch> TitleTrie::searchFuzzy(std::string_view text, int maxEdits) const {
+    std::vector<FuzzyMatch> result;
+    if (maxEdits < 0) {
+        return result;
+    }
+
+    // Mesma regra do insert: caracteres fora de ASCII não estão na TRIE
+    std::string query;
+    query.reserve(text.size());
+    for (char c : text) {
+        if (static_cast<unsigned char>(c) < 128) query.push_back(lowerAscii(c));
+    }
+    if (query.empty()) {
+        return result;
+    }
+
+    const int m = static_cast<int>(query.size());
+    const std::size_t width = query.size() + 1;
+    const int limit = maxEdits + 1;
+
+    // Linhas no fim do rótulo de cada nó já visitado que tem filhos; a raiz usa a linha 0..m
+    std::vector<int> rows(width);
+    for (int j = 0; j <= m; ++j) rows[j] = j;
+
+    // Duas linhas de trabalho para andar pelos caracteres de um rótulo
+    std::vector<int> scratchA(width), scratchB(width);
+
+    struct Frame {
+        int node;
+        std::size_t row; // linha do fim do rótulo do pai, em rows
+        int best;        // menor linha[m] no caminho até o pai
+    };
+    std::vector<Frame> stack{Frame{0, 0, m}};
+    std::vector<int> subtree;
+
+    while (!stack.empty()) {
+        Frame frame = stack.back();
+        stack.pop_back();
+        const TrieNode& node = nodes[frame.node];
+
+        const int* prev = rows.data() + frame.row;
+        int* cur = scratchA.data();
+        int* spare = scratchB.data();
+        int best = frame.best;
+        bool settled = false;
+
+        for (std::uint32_t i = 0; i < node.labelLength; ++i) {
+            char c = lowerAscii(labels[node.labelOffset + i]);
+            cur[0] = prev[0] + 1;
+            int rowMin = cur[0];
+            for (int j = 1; j <= m; ++j) {
+                int v = std::min(prev[j], cur[j - 1]) + 1;
+                v = std::min(v, prev[j - 1] + (query[j - 1] == c ? 0 : 1));
+                cur[j] = v;
+                rowMin = std::min(rowMin, v);
+            }
+            best = std::min(best, cur[m]);
+            prev = cur;
+            std::swap(cur, spare);
+
+            if (rowMin >= std::min(best, limit)) {
+                settled = true;
+                break;
+            }
+        }
+
+        if (settled) {
+            if (best <= maxEdits) {
+                subtree.clear();
+                collect(frame.node, subtree);
+                for (int id : subtree) result.push_back(FuzzyMatch{id, best});
+            }
+            continue;
+        }
+
+        if (best <= maxEdits) {
+            for (int id = node.firstId; id != -1; id = idNext[id]) {
+                result.push_back(FuzzyMatch{ids[id], best});
+            }
+        }
+        if (node.firstChild == -1) {
+            continue;
+        }
+
+        // Só a raiz não tem rótulo; nos demais a linha final está em uma das linhas de trabalho
+        std::size_t childRow = frame.row;
+        if (node.labelLength > 0) {
+            childRow = rows.size();
+            rows.insert(rows.end(), prev, prev + width);
+        }
+        for (int c = node.firstChild; c != -1; c = nodes[c].nextSibling) {
+            stack.push_back(Frame{c, childRow, best});
+        }
     }
+    return result;
+}
+
+// Percorre a subárvore em pré-ordem (ids do nó, depois filhos em ordem de caractere)
+// usando uma pilha explícita no lugar de recursão
+void TitleTrie::collect(int node, std::vector<int>& out) const {
+    std::vector<int> stack;
+    stack.push_back(node);
+
+    while (!stack.empty()) {
+        int n = stack.back();
+        stack.pop_back();
 
-    for (int i = 0; i < 128; ++i) {
-        if (node->children[i] != nullptr) {
-            freeNode(node->children[i]);
+        for (int id = nodes[n].firstId; id != -1; id = idNext[id]) {
+            out.push_back(ids[id]);
+        }
+
+        // O irmão é empilhado antes do filho para que o filho seja visitado primeiro
+        if (n != node && nodes[n].nextSibling != -1) {
+            stack.push_back(nodes[n].nextSibling);
+        }
+        if (nodes[n].firstChild != -1) {
+            stack.push_back(nodes[n].firstChild);
         }
     }
+}
+
+std::size_t TitleTrie::nodeCount() const {
+    return nodes.size();
+}
+
+std::size_t TitleTrie::titleCount() const {
+    return ids.size();
+}
 
-    delete node;
+std::size_t TitleTrie::memoryUsage() const {
+    return sizeof(TitleTrie)
+        + nodes.capacity() * sizeof(TrieNode)
+        + labels.capacity()
+        + ids.capacity() * sizeof(int)
+        + idNext.capacity() * sizeof(int)
+        + rankOf.capacity() * (sizeof(std::uint8_t) + 2 * sizeof(int))
+        + rankedIds.capacity() * sizeof(int)
+        + topCache.capacity() * sizeof(int);
 }
@@ -0,0 +1,152 @@
+#include "trigram_index.hpp"
+#include "intersect.hpp"
+#include "sort_utils.hpp"
+
+#include <string>
+
+namespace {
+
+// Minúsculas só em ASCII; os outros bytes ficam como estão
+void foldCase(std::string_view s, std::string& out) {
+    out.clear();
+    for (char c : s) {
+        out.push_back((c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c);
+    }
+}
+
+int trigramAt(const std::string& s, std::size_t i) {
+    return (static_cast<unsigned char>(s[i]) << 16) |
+           (static_cast<unsigned char>(s[i + 1]) << 8) |
+           static_cast<unsigned char>(s[i + 2]);
+}
+
+// needle (já em minúsculas) aparece em title, comparando title em minúsculas
+bool containsFolded(std::string_view title, const std::string& needle) {
+    if (needle.size() > title.size()) return false;
+    for (std::size_t i = 0; i + needle.size() <= title.size(); ++i) {
+        std::size_t j = 0;
+        while (j < needle.size()) {
+            char c = title[i + j];
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+            if (c != needle[j]) break;
+            ++j;
+        }
+        if (j == needle.size()) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+// Duas passadas pelos títulos: a primeira numera os trigramas e conta os títulos de cada
+// um, a segunda preenche as listas. Os títulos são visitados em ordem, então cada lista já
+// sai crescente; lastTitle evita repetir um título que tem o mesmo trigrama duas vezes.
+void TrigramIndex::build(const MovieStore& movies) {
+    lists = hash_table::OpenHashTable<int, int, hash_table::IntHash>(movies.size());
+    offsets.clear();
+    postings.clear();
+
+    std::vector<std::uint32_t> counts;
+    std::vector<int> lastTitle;
+    std::string folded;
+
+    for (std::size_t m = 0; m < movies.size(); ++m) {
+        foldCase(movies.title(static_cast<int>(m)), folded);
+        for (std::size_t i = 0; i + 3 <= folded.size(); ++i) {
+            bool inserted = false;
+            int& list = lists.insertOrGet(trigramAt(folded, i), inserted);
+            if (inserted) {
+                list = static_cast<int>(counts.size());
+                counts.push_back(0);
+                lastTitle.push_back(-1);
+            }
+            if (lastTitle[list] != static_cast<int>(m)) {
+                lastTitle[list] = static_cast<int>(m);
+                ++counts[list];
+            }
+        }
+    }
+
+    offsets.resize(counts.size() + 1);
+    offsets[0] = 0;
+    for (std::size_t t = 0; t < counts.size(); ++t) {
+        offsets[t + 1] = offsets[t] + counts[t];
+    }
+    postings.resize(offsets.back());
+
+    std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    lastTitle.assign(counts.size(), -1);
+    for (std::size_t m = 0; m < movies.size(); ++m) {
+        foldCase(movies.title(static_cast<int>(m)), folded);
+        for (std::size_t i = 0; i + 3 <= folded.size(); ++i) {
+            int list = *lists.find(trigramAt(folded, i));
+            if (lastTitle[list] != static_cast<int>(m)) {
+                lastTitle[list] = static_cast<int>(m);
+                postings[cursor[list]++] = static_cast<int>(m);
+            }
+        }
+    }
+}
+
+std::vector<int> TrigramIndex::search(const MovieStore& movies, std::string_view text,
+                                      std::size_t& candidates) const {
+    std::vector<int> result;
+    candidates = 0;
+
+    std::string needle;
+    foldCase(text, needle);
+    if (needle.empty()) {
+        return result;
+    }
+
+    // Texto curto: não há trigrama para filtrar, confere todos os títulos
+    if (needle.size() < 3) {
+        candidates = movies.size();
+        for (std::size_t m = 0; m < movies.size(); ++m) {
+            if (containsFolded(movies.title(static_cast<int>(m)), needle)) {
+                result.push_back(static_cast<int>(m));
+            }
+        }
+        return result;
+    }
+
+    struct PostingList {
+        const int* data;
+        std::size_t size;
+    };
+    std::vector<PostingList> found;
+    for (std::size_t i = 0; i + 3 <= needle.size(); ++i) {
+        const int* list = lists.find(trigramAt(needle, i));
+        if (list == nullptr) {
+            return result; // trigrama que não aparece em nenhum título
+        }
+        found.push_back(PostingList{postings.data() + offsets[*list], offsets[*list + 1] - offsets[*list]});
+    }
+
+    // Da menor para a maior: o resultado parcial só diminui
+    sort_utils::quickSort(found, [](const PostingList& a, const PostingList& b) { return a.size < b.size; });
+
+    std::vector<int> current(found[0].data, found[0].data + found[0].size);
+    std::vector<int> next;
+    for (std::size_t i = 1; i < found.size() && !current.empty(); ++i) {
+        next.clear();
+        intersect::intersectPair(current.data(), current.size(), found[i].data, found[i].size, next);
+        current.swap(next);
+    }
+
+    candidates = current.size();
+    for (int m : current) {
+        if (containsFolded(movies.title(m), needle)) result.push_back(m);
+    }
+    return result;
+}
+
+std::size_t TrigramIndex::trigramCount() const {
+    return lists.size();
+}
+
+std::size_t TrigramIndex::memoryUsage() const {
+    return lists.capacity() * (sizeof(std::uint8_t) + 2 * sizeof(int))
+        + offsets.capacity() * sizeof(std::uint32_t)
+        + postings.capacity() * sizeof(int);
+}
@@ -1,85 +1,140 @@
 #include "users.hpp"
 #include <cstddef>
-#include <stdexcept>
 
-UserHashTable::UserHashTable(std::size_t capacity) : table(), count(0) {
-    std::size_t cap = capacity == 0 ? 1 : capacity;
-    table.resize(cap);
+UserStore::UserStore(std::size_t expected) : index(expected) {
+    ids.reserve(expected);
 }
 
-std::size_t UserHashTable::hash(int key) const {
-    return static_cast<std::size_t>(key) % table.size();
+int UserStore::insertOrGet(int userId) {
+    bool inserted = false;
+    int& slot = index.insertOrGet(userId, inserted);
+    if (inserted) {
+        slot = static_cast<int>(ids.size());
+        ids.push_back(userId);
+    }
+    return slot;
 }
 
-std::size_t UserHashTable::probe(std::size_t h, std::size_t step) const {
-    return (h + step) % table.size();
+void UserStore::addRating(int user, int movieId, float rating) {
+    stagedUsers.push_back(user);
+    stagedMovieIds.push_back(movieId);
+    stagedRatings.push_back(rating);
 }
 
-User& UserHashTable::insertOrGet(int userId) {
-    std::size_t h = hash(userId);
-
-    for (std::size_t step = 0; step < table.size(); ++step) {
-        std::size_t idx = probe(h, step);
-        UserHashEntry& entry = table[idx];
-
-        if (entry.occupied) {
-            // Achou o usuário certo
-            if (!entry.deleted && entry.key == userId) {
-                return entry.value;
-            }
-            // Caso contrário, continua probing
-        } else {
-            // Slot livre → inserir aqui
-            entry.key               = userId;
-            entry.value.userId      = userId;
-            entry.value.ratings.clear();
-            entry.occupied          = true;
-            entry.deleted           = false;
-            ++count;
-
-            return entry.value;
-        }
+void UserStore::append(const UserStore& other) {
+    // Índice local (em other) -> índice aqui
+    std::vector<int> remap(other.ids.size());
+    for (std::size_t i = 0; i < other.ids.size(); ++i) {
+        remap[i] = insertOrGet(other.ids[i]);
     }
 
-    // Se chegou aqui, a tabela está cheia (não deveria acontecer no trabalho)
-    throw std::runtime_error("UserHashTable::insertOrGet – Hash table full");
+    std::size_t base = stagedUsers.size();
+    stagedUsers.resize(base + other.stagedUsers.size());
+    for (std::size_t i = 0; i < other.stagedUsers.size(); ++i) {
+        stagedUsers[base + i] = remap[other.stagedUsers[i]];
+    }
+    stagedMovieIds.insert(stagedMovieIds.end(), other.stagedMovieIds.begin(), other.stagedMovieIds.end());
+    stagedRatings.insert(stagedRatings.end(), other.stagedRatings.begin(), other.stagedRatings.end());
 }
 
-User* UserHashTable::find(int userId) {
-    std::size_t h = hash(userId);
+void UserStore::finalize(const MovieStore& catalog) {
+    // Já finalizado e nada novo para juntar
+    if (stagedUsers.empty() && offsets.size() == ids.size() + 1) return;
 
-    for (std::size_t step = 0; step < table.size(); ++step) {
-        std::size_t idx = probe(h, step);
-        UserHashEntry& entry = table[idx];
+    std::size_t total = stagedUsers.size();
 
-        // Se achou um slot que nunca foi usado → não existe
-        if (!entry.occupied && !entry.deleted) {
-            return nullptr;
+    // Contagem por usuário e soma de prefixos: offsets[u] é o início das avaliações de u
+    offsets.assign(ids.size() + 1, 0);
+    for (std::int32_t u : stagedUsers) {
+        ++offsets[u + 1];
+    }
+    for (std::size_t u = 0; u < ids.size(); ++u) {
+        offsets[u + 1] += offsets[u];
+    }
+
+    // Notas em meias estrelas, se todas couberem
+    bool halfStars = true;
+    for (float r : stagedRatings) {
+        float twice = r * 2.0f;
+        if (!(twice >= 0.0f && twice <= 255.0f) || twice != static_cast<float>(static_cast<int>(twice))) {
+            halfStars = false;
+            break;
         }
+    }
+
+    movies.assign(total, 0);
+    codes.clear();
+    exact.clear();
+    if (halfStars) {
+        codes.assign(total, 0);
+    } else {
+        exact.assign(total, 0.0f);
+    }
 
-        if (entry.occupied && !entry.deleted && entry.key == userId) {
-            return &entry.value;
+    // Distribui na ordem de preparação, então cada usuário mantém a ordem do arquivo
+    std::vector<std::uint64_t> next(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i = 0; i < total; ++i) {
+        std::uint64_t pos = next[stagedUsers[i]]++;
+        movies[pos] = catalog.indexOf(stagedMovieIds[i]);
+        if (halfStars) {
+            codes[pos] = static_cast<std::uint8_t>(stagedRatings[i] * 2.0f);
+        } else {
+            exact[pos] = stagedRatings[i];
         }
     }
 
-    return nullptr;
+    std::vector<std::int32_t>().swap(stagedUsers);
+    std::vector<std::int32_t>().swap(stagedMovieIds);
+    std::vector<float>().swap(stagedRatings);
 }
 
-const User* UserHashTable::find(int userId) const {
-    std::size_t h = hash(userId);
+bool UserStore::assign(std::vector<int> userIds, std::vector<std::uint64_t> userOffsets,
+                       std::vector<std::int32_t> movieIndexes, std::vector<std::uint8_t> ratingCodes,
+                       std::vector<float> exactRatings) {
+    *this = UserStore(userIds.size());
+    for (std::size_t i = 0; i < userIds.size(); ++i) {
+        bool inserted = false;
+        int& slot = index.insertOrGet(userIds[i], inserted);
+        if (!inserted) return false;
+        slot = static_cast<int>(i);
+    }
 
-    for (std::size_t step = 0; step < table.size(); ++step) {
-        std::size_t idx = probe(h, step);
-        const UserHashEntry& entry = table[idx];
+    ids = std::move(userIds);
+    offsets = std::move(userOffsets);
+    movies = std::move(movieIndexes);
+    codes = std::move(ratingCodes);
+    exact = std::move(exactRatings);
+    return true;
+}
 
-        if (!entry.occupied && !entry.deleted) {
-            return nullptr;
-        }
+int UserStore::indexOf(int userId) const {
+    const int* slot = index.find(userId);
+    return slot ? *slot : -1;
+}
 
-        if (entry.occupied && !entry.deleted && entry.key == userId) {
-            return &entry.value;
-        }
+RatingSpan UserStore::ratings(int user) const {
+    RatingSpan span;
+    std::uint64_t begin = offsets[user];
+    span.size = static_cast<std::size_t>(offsets[user + 1] - begin);
+    span.movies = movies.data() + begin;
+    if (exact.empty()) {
+        span.codes = codes.data() + begin;
+    } else {
+        span.exact = exact.data() + begin;
     }
+    return span;
+}
+
+std::size_t UserStore::capacity() const {
+    return index.capacity();
+}
+
+std::size_t UserStore::maxProbeLength() const {
+    return index.maxProbeLength();
+}
 
-    return nullptr;
+std::size_t UserStore::memoryUsage() const {
+    return index.capacity() * (1 + 2 * sizeof(int)) + ids.capacity() * sizeof(int) +
+           offsets.capacity() * sizeof(std::uint64_t) + movies.capacity() * sizeof(std::int32_t) +
+           codes.capacity() + exact.capacity() * sizeof(float);
 }
@@ -0,0 +1,118 @@
+#include "work_stealing_pool.hpp"
+
+WorkStealingPool::WorkStealingPool(std::size_t threads)
+    : threadCount(threads == 0 ? 1 : threads), ranges(new Range[threads == 0 ? 1 : threads]) {
+    // A thread 0 é quem chama run
+    workers.reserve(threadCount - 1);
+    for (std::size_t i = 1; i < threadCount; ++i) {
+        workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& w : workers) {
+        w.join();
+    }
+}
+
+void WorkStealingPool::run(std::size_t count, const std::function<void(std::size_t)>& task) {
+    if (count == 0) return;
+
+    for (std::size_t t = 0; t < threadCount; ++t) {
+        std::lock_guard<std::mutex> lock(ranges[t].mtx);
+        ranges[t].begin = count * t / threadCount;
+        ranges[t].end = count * (t + 1) / threadCount;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        current = &task;
+        busy = workers.size();
+        ++generation;
+    }
+    wake.notify_all();
+
+    work(0, task);
+
+    std::unique_lock<std::mutex> lock(mtx);
+    done.wait(lock, [this] { return busy == 0; });
+    current = nullptr;
+}
+
+std::size_t WorkStealingPool::size() const {
+    return threadCount;
+}
+
+void WorkStealingPool::workerLoop(std::size_t self) {
+    std::size_t seen = 0;
+    for (;;) {
+        const std::function<void(std::size_t)>* task;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            task = current;
+        }
+
+        work(self, *task);
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            --busy;
+            if (busy == 0) {
+                done.notify_all();
+            }
+        }
+    }
+}
+
+// Executa o próprio trecho e depois rouba até não sobrar nada em nenhuma thread
+void WorkStealingPool::work(std::size_t self, const std::function<void(std::size_t)>& task) {
+    for (;;) {
+        std::size_t index;
+        if (takeOwn(self, index)) {
+            task(index);
+        } else if (!steal(self)) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::takeOwn(std::size_t self, std::size_t& index) {
+    Range& own = ranges[self];
+    std::lock_guard<std::mutex> lock(own.mtx);
+    if (own.begin == own.end) return false;
+    index = own.begin++;
+    return true;
+}
+
+// Pega a metade final do trecho restante da primeira thread (a partir da seguinte) que
+// ainda tiver índices; false se todas estiverem vazias
+bool WorkStealingPool::steal(std::size_t self) {
+    for (std::size_t step = 1; step < threadCount; ++step) {
+        Range& victim = ranges[(self + step) % threadCount];
+        std::size_t begin, end;
+        {
+            std::lock_guard<std::mutex> lock(victim.mtx);
+            if (victim.begin == victim.end) continue;
+            end = victim.end;
+            begin = victim.begin + (victim.end - victim.begin) / 2;
+            victim.end = begin;
+        }
+
+        Range& own = ranges[self];
+        std::lock_guard<std::mutex> lock(own.mtx);
+        own.begin = begin;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
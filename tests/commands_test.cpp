@@ -0,0 +1,113 @@
+// Testes de regressão da interpretação dos comandos (commands::execute).
+//
+// Monta um DataContext pequeno em memória, roda linhas de comando com --output tsv e confere
+// quais títulos aparecem. Imprime cada falha e sai com código 1 se alguma falhar.
+//
+// Compilar e rodar (na raiz do projeto):
+//   g++ -std=c++17 -O2 -pthread -Iinclude tests/commands_test.cpp $(ls src/*.cpp | grep -v '/main.cpp') -o commands_test
+//   ./commands_test
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#include "commands.hpp"
+#include "data_loader.hpp"
+
+namespace {
+
+int failures = 0;
+
+struct Result {
+    std::string out;
+    std::string err;
+};
+
+Result run(const DataContext& ctx, const std::string& line) {
+    commands::Options options;
+    options.format = OutputFormat::Tsv;
+    std::ostringstream out, err;
+    commands::execute(ctx, line, options, out, err);
+    return Result{out.str(), err.str()};
+}
+
+void check(bool ok, const std::string& line, const char* what) {
+    if (!ok) {
+        std::printf("FAIL: %s: %s\n", line.c_str(), what);
+        ++failures;
+    }
+}
+
+std::size_t countRows(const std::string& tsv) {
+    // cabeçalho + uma linha por registro + linha em branco no fim
+    std::size_t lines = 0;
+    for (char c : tsv) lines += c == '\n';
+    return lines >= 2 ? lines - 2 : 0;
+}
+
+void addMovie(DataContext& ctx, int movieId, const char* title, double rating) {
+    int idx = ctx.movies.insertOrGet(movieId);
+    ctx.movies.setInfo(idx, title, "Comedy", 0);
+    ctx.movies.addRating(idx, rating);
+    ctx.trie.insert(title, movieId);
+}
+
+} // namespace
+
+int main() {
+    DataContext ctx;
+    addMovie(ctx, 1, "101 Dalmatians (1961)", 4.0);
+    addMovie(ctx, 2, "101 Reykjavik (2000)", 3.0);
+    addMovie(ctx, 3, "Dalton (1990)", 2.0);
+    addMovie(ctx, 4, "50 First Dates (2004)", 3.5);
+    // movieId no limite do int: o ranking da TRIE não pode ser um vetor indexado pelo id
+    addMovie(ctx, 2147483647, "Zardoz (1974)", 5.0);
+    // Tags com cara de operador
+    ctx.tags.addMovie("-1", 1);
+    ctx.tags.addMovie("|", 2);
+    ctx.tags.addMovie("classic", 1);
+    ctx.tags.addMovie("classic", 3);
+    data_loader::buildIndexes(ctx);
+
+    // Títulos que começam com número continuam sendo buscados pelo texto inteiro
+    Result r = run(ctx, "prefix 101 Dal");
+    check(r.out.find("101 Dalmatians") != std::string::npos, "prefix 101 Dal", "missing 101 Dalmatians");
+    check(r.out.find("Reykjavik") == std::string::npos, "prefix 101 Dal", "unexpected 101 Reykjavik");
+    check(countRows(r.out) == 1, "prefix 101 Dal", "expected one row");
+
+    r = run(ctx, "prefix 50 First");
+    check(r.out.find("50 First Dates") != std::string::npos, "prefix 50 First", "missing 50 First Dates");
+
+    r = run(ctx, "prefix 101");
+    check(countRows(r.out) == 2, "prefix 101", "expected two rows");
+
+    // Forma com os N melhores
+    r = run(ctx, "prefix -n 1 101");
+    check(countRows(r.out) == 1, "prefix -n 1 101", "expected one row");
+    check(r.out.find("101 Dalmatians") != std::string::npos, "prefix -n 1 101", "expected the best ranked title");
+
+    r = run(ctx, "prefix -n x Dal");
+    check(r.out.empty() && !r.err.empty(), "prefix -n x Dal", "expected an error");
+
+    r = run(ctx, "prefix -n 1 Z");
+    check(r.out.find("Zardoz") != std::string::npos, "prefix -n 1 Z", "missing the movie with the largest id");
+
+    // Termos entre aspas são tags literais; fora das aspas, "-tag" e "|" são operadores
+    r = run(ctx, "tags '-1'");
+    check(countRows(r.out) == 1 && r.out.find("101 Dalmatians") != std::string::npos, "tags '-1'", "expected the movie tagged -1");
+
+    r = run(ctx, "tags classic '-1'");
+    check(countRows(r.out) == 1 && r.out.find("101 Dalmatians") != std::string::npos, "tags classic '-1'", "expected the AND of both tags");
+
+    r = run(ctx, "tags '|'");
+    check(countRows(r.out) == 1 && r.out.find("101 Reykjavik") != std::string::npos, "tags '|'", "expected the movie tagged |");
+
+    r = run(ctx, "tags classic -'-1'");
+    check(countRows(r.out) == 1 && r.out.find("Dalton") != std::string::npos, "tags classic -'-1'", "expected classic without -1");
+
+    r = run(ctx, "tags classic | '|'");
+    check(countRows(r.out) == 3, "tags classic | '|'", "expected three rows");
+
+    if (failures == 0) std::printf("all tests passed\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+// Conexão com o servidor de consultas, usada por ms_client e loadgen.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Socket conectado em unixPath (se não for vazio) ou em 127.0.0.1:tcpPort; -1 e error
+// preenchido se falhar.
+inline int connectToServer(const std::string& unixPath, int tcpPort, std::string& error) {
+    int fd = -1;
+    if (!unixPath.empty()) {
+        sockaddr_un addr{};
+        if (unixPath.size() >= sizeof(addr.sun_path)) {
+            error = "socket path too long: " + unixPath;
+            return -1;
+        }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, unixPath.c_str(), unixPath.size() + 1);
+        fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return fd;
+        error = "cannot connect to " + unixPath + ": " + std::strerror(errno);
+    } else {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<std::uint16_t>(tcpPort));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+            // Pedidos pequenos em sequência: não esperar o ACK do anterior
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            return fd;
+        }
+        error = "cannot connect to 127.0.0.1:" + std::to_string(tcpPort) + ": " + std::strerror(errno);
+    }
+    if (fd >= 0) ::close(fd);
+    return -1;
+}
+
+// Escreve todo o buffer; false se a conexão caiu
+inline bool writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
@@ -0,0 +1,478 @@
+// Gerador determinístico de dados no formato do MovieLens (movies.csv, ratings.csv, tags.csv).
+//
+// Escala 1 fica perto do MovieLens 1M: 1M de avaliações de 6.040 usuários sobre 4.000 filmes,
+// mais 10 mil tags. Avaliações, usuários e tags crescem com a escala; o catálogo cresce com a
+// raiz dela, como entre as versões do MovieLens (10x ≈ ML-10M, 100x ≈ 4x o ML-25M em avaliações).
+//
+// - Popularidade dos filmes segue Zipf-Mandelbrot (peso 1/(posição + 100)): os mais vistos
+//   passam de 1000 avaliações já na escala 1 e a cauda é longa, como no MovieLens.
+// - Todo usuário tem pelo menos 20 avaliações; o excedente segue uma cauda Zipf entre usuários.
+//   Um usuário não avalia o mesmo filme duas vezes. O arquivo sai ordenado por userId e movieId.
+// - Nota = qualidade do filme + viés do usuário + ruído, arredondada para estrelas (70%) ou meias.
+// - Títulos são 1 a 4 palavras de um vocabulário com frequências Zipf (prefixos compartilhados
+//   na trie); parte vem no formato "Nome, The" entre aspas, como no arquivo original.
+// - Tags: poucos usuários marcam muitos filmes, vocabulário Zipf, maiúsculas e espaços variados.
+//
+// O gerador de números é próprio (SplitMix64), então a mesma semente e a mesma escala geram os
+// mesmos arquivos em qualquer compilador/biblioteca padrão.
+//
+// Uso:
+//   gen_movielens [--scale S] [--seed N] DIR
+//
+// Compilar (na raiz do projeto):
+//   g++ -std=c++17 -O2 -Iinclude tools/gen_movielens.cpp -o gen_movielens
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "sort_utils.hpp"
+
+namespace {
+
+// Escala 1
+const double kBaseRatings = 1000000.0;
+const double kBaseUsers = 6040.0;
+const double kBaseMovies = 4000.0;
+const double kBaseTags = 10000.0;
+
+const std::size_t kMinRatingsPerUser = 20;
+const double kPopularityOffset = 100.0;
+const double kTaggerFraction = 0.05;
+
+const char* const kGenres[] = {
+    "Drama", "Comedy", "Thriller", "Romance", "Action", "Crime", "Documentary", "Horror",
+    "Adventure", "Sci-Fi", "Mystery", "Fantasy", "War", "Children", "Animation", "Musical",
+    "Western", "Film-Noir", "IMAX",
+};
+const std::size_t kGenreCount = sizeof(kGenres) / sizeof(kGenres[0]);
+
+// Começo do vocabulário de tags; o resto é gerado
+const char* const kCommonTags[] = {
+    "atmospheric", "twist ending", "thought-provoking", "dark comedy", "based on a book",
+    "sci-fi", "funny", "visually appealing", "classic", "surreal", "quirky", "cult film",
+    "violence", "romance", "great soundtrack", "psychology", "nonlinear", "dystopia",
+    "philosophical", "action", "black comedy", "stylized", "time travel", "comedy",
+    "space", "animation", "disney", "mindfuck", "true story", "war",
+};
+const std::size_t kCommonTagCount = sizeof(kCommonTags) / sizeof(kCommonTags[0]);
+
+const char* const kSyllables[] = {
+    "ka", "ro", "mi", "ten", "sa", "lo", "ver", "an", "del", "ri", "mo", "tar", "be", "nu",
+    "li", "cor", "da", "fen", "go", "ha", "ja", "kel", "ma", "nor", "pi", "qua", "sel", "tu",
+    "vi", "wen", "xa", "yor", "zen", "bra", "cla", "dri", "fro", "gla", "pre", "stra",
+};
+const std::size_t kSyllableCount = sizeof(kSyllables) / sizeof(kSyllables[0]);
+
+// SplitMix64: rápido, bom o bastante para dados sintéticos e igual em qualquer plataforma
+class Random {
+public:
+    explicit Random(std::uint64_t seed) : state(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // [0, 1)
+    double uniform() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    // [0, n)
+    std::size_t below(std::size_t n) { return static_cast<std::size_t>(uniform() * static_cast<double>(n)); }
+
+    // Normal padrão (Box-Muller)
+    double normal() {
+        double u1 = 1.0 - uniform();
+        double u2 = uniform();
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+    }
+
+private:
+    std::uint64_t state;
+};
+
+// Sorteio de posições 0..n-1 com peso 1/(posição + offset)^exponent (busca na soma acumulada)
+class ZipfSampler {
+public:
+    ZipfSampler(std::size_t n, double offset, double exponent) : cumulative(n) {
+        double sum = 0.0;
+        for (std::size_t r = 0; r < n; ++r) {
+            sum += 1.0 / std::pow(static_cast<double>(r) + offset, exponent);
+            cumulative[r] = sum;
+        }
+    }
+
+    std::size_t sample(Random& rng) const {
+        double x = rng.uniform() * cumulative.back();
+        std::size_t lo = 0, hi = cumulative.size() - 1;
+        while (lo < hi) {
+            std::size_t mid = lo + (hi - lo) / 2;
+            if (cumulative[mid] <= x) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    // Fração do peso total na posição r
+    double share(std::size_t r) const {
+        double prev = r == 0 ? 0.0 : cumulative[r - 1];
+        return (cumulative[r] - prev) / cumulative.back();
+    }
+
+private:
+    std::vector<double> cumulative;
+};
+
+// Permutação aleatória de 0..n-1 (Fisher-Yates)
+std::vector<std::size_t> shuffled(std::size_t n, Random& rng) {
+    std::vector<std::size_t> order(n);
+    for (std::size_t i = 0; i < n; ++i) order[i] = i;
+    for (std::size_t i = n; i > 1; --i) {
+        std::size_t j = rng.below(i);
+        std::size_t tmp = order[i - 1];
+        order[i - 1] = order[j];
+        order[j] = tmp;
+    }
+    return order;
+}
+
+// Saída em blocos grandes, números com to_chars
+class CsvWriter {
+public:
+    explicit CsvWriter(std::FILE* file) : file(file) { buffer.reserve(kFlushSize + 4096); }
+    ~CsvWriter() { flush(); }
+
+    void text(const std::string& s) { buffer += s; }
+    void text(const char* s) { buffer += s; }
+    void put(char c) { buffer.push_back(c); }
+
+    template <typename T>
+    void number(T value) {
+        char tmp[24];
+        std::to_chars_result r = std::to_chars(tmp, tmp + sizeof(tmp), value);
+        buffer.append(tmp, r.ptr);
+    }
+
+    void endLine() {
+        buffer.push_back('\n');
+        if (buffer.size() >= kFlushSize) flush();
+    }
+
+    void flush() {
+        std::fwrite(buffer.data(), 1, buffer.size(), file);
+        buffer.clear();
+    }
+
+private:
+    static const std::size_t kFlushSize = 1 << 20;
+    std::FILE* file;
+    std::string buffer;
+};
+
+std::string capitalized(std::string word) {
+    if (!word.empty() && word[0] >= 'a' && word[0] <= 'z') word[0] = static_cast<char>(word[0] - 'a' + 'A');
+    return word;
+}
+
+// Palavras inventadas de 1 a 3 sílabas (repetições só somam o peso da palavra)
+std::vector<std::string> makeWords(std::size_t count, Random& rng) {
+    std::vector<std::string> words(count);
+    for (std::string& w : words) {
+        std::size_t syllables = 1 + rng.below(3);
+        for (std::size_t s = 0; s < syllables; ++s) w += kSyllables[rng.below(kSyllableCount)];
+    }
+    return words;
+}
+
+struct Movie {
+    int id;
+    double quality;  // nota média esperada
+};
+
+struct Sizes {
+    std::size_t ratings, users, movies, tags;
+};
+
+bool openOutput(const std::string& path, std::FILE*& file, std::string& error) {
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) error = "cannot write " + path;
+    return file != nullptr;
+}
+
+// movies.csv: movieId,title,genres,year (como data/movies.csv). Devolve os filmes na ordem de
+// popularidade (posição 0 = mais avaliado).
+bool writeMovies(const std::string& path, std::size_t count, Random& rng,
+                 std::vector<Movie>& byPopularity, std::string& error) {
+    std::FILE* file;
+    if (!openOutput(path, file, error)) return false;
+
+    std::vector<std::string> words = makeWords(2000 + count / 4, rng);
+    ZipfSampler wordSampler(words.size(), 1.0, 1.0);
+    ZipfSampler genreSampler(kGenreCount, 1.0, 1.0);
+
+    std::vector<Movie> movies(count);
+    {
+        CsvWriter out(file);
+        out.text("movieId,title,genres,year");
+        out.endLine();
+
+        int id = 0;
+        for (std::size_t m = 0; m < count; ++m) {
+            // ids crescentes com buracos, como no MovieLens
+            id += 1 + (rng.uniform() < 0.2 ? static_cast<int>(rng.below(40)) : 0);
+
+            std::string title;
+            std::size_t wordCount = 1 + rng.below(4);
+            for (std::size_t w = 0; w < wordCount; ++w) {
+                if (w > 0) title += ' ';
+                title += capitalized(words[wordSampler.sample(rng)]);
+            }
+            double article = rng.uniform();
+            bool quoted = false;
+            if (article < 0.10) {
+                title += ", The";
+                quoted = true;
+            } else if (article < 0.15) {
+                title = "The " + title;
+            } else if (article < 0.17) {
+                title += ", A";
+                quoted = true;
+            }
+
+            // 1 a 3 gêneros distintos, na ordem do sorteio
+            std::size_t picked[3];
+            std::size_t genreCount = 1 + rng.below(3);
+            std::size_t used = 0;
+            for (std::size_t tries = 0; used < genreCount && tries < 10; ++tries) {
+                std::size_t g = genreSampler.sample(rng);
+                bool repeated = false;
+                for (std::size_t k = 0; k < used; ++k) repeated = repeated || picked[k] == g;
+                if (!repeated) picked[used++] = g;
+            }
+
+            // Mais filmes recentes
+            int year = 2020 - static_cast<int>(std::fabs(rng.normal()) * 25.0);
+            if (year < 1902) year = 1902;
+
+            out.number(id);
+            out.put(',');
+            if (quoted) out.put('"');
+            out.text(title);
+            if (quoted) out.put('"');
+            out.put(',');
+            for (std::size_t k = 0; k < used; ++k) {
+                if (k > 0) out.put('|');
+                out.text(kGenres[picked[k]]);
+            }
+            out.put(',');
+            out.number(year);
+            out.endLine();
+
+            movies[m] = Movie{id, 3.5 + 0.45 * rng.normal()};
+        }
+    }
+    if (std::fclose(file) != 0) {
+        error = "cannot write " + path;
+        return false;
+    }
+
+    // Popularidade sem relação com o id; os mais populares são um pouco melhores
+    std::vector<std::size_t> order = shuffled(count, rng);
+    byPopularity.clear();
+    for (std::size_t r = 0; r < count; ++r) {
+        Movie movie = movies[order[r]];
+        movie.quality += 0.3 / (1.0 + static_cast<double>(r) / 200.0);
+        byPopularity.push_back(movie);
+    }
+    return true;
+}
+
+// Nota em estrelas (70%) ou meias estrelas, entre 0.5 e 5
+double roundRating(double value, Random& rng) {
+    double step = rng.uniform() < 0.7 ? 1.0 : 0.5;
+    double r = std::floor(value / step + 0.5) * step;
+    if (r < step) r = step;
+    if (r > 5.0) r = 5.0;
+    return r;
+}
+
+// ratings.csv: userId,movieId,rating,timestamp, por userId e movieId. Retorna as linhas escritas.
+bool writeRatings(const std::string& path, const Sizes& sizes, const std::vector<Movie>& byPopularity,
+                  Random& rng, std::size_t& written, std::string& error) {
+    std::FILE* file;
+    if (!openOutput(path, file, error)) return false;
+
+    std::size_t movieCount = byPopularity.size();
+    ZipfSampler popularity(movieCount, kPopularityOffset, 1.0);
+
+    // Excedente sobre o mínimo de 20, distribuído por atividade (posição aleatória por usuário)
+    std::size_t base = kMinRatingsPerUser * sizes.users;
+    double extra = sizes.ratings > base ? static_cast<double>(sizes.ratings - base) : 0.0;
+    ZipfSampler activity(sizes.users, static_cast<double>(sizes.users) / 20.0, 1.0);
+    std::vector<std::size_t> activityRank = shuffled(sizes.users, rng);
+    std::size_t maxPerUser = movieCount / 3;
+    if (maxPerUser < kMinRatingsPerUser) maxPerUser = movieCount;
+
+    // seen[m] == usuário atual + 1 marca filme já avaliado por ele
+    std::vector<std::size_t> seen(movieCount, 0);
+    std::vector<std::size_t> picked;
+    written = 0;
+    {
+        CsvWriter out(file);
+        out.text("userId,movieId,rating,timestamp");
+        out.endLine();
+
+        for (std::size_t u = 0; u < sizes.users; ++u) {
+            double share = activity.share(activityRank[u]);
+            std::size_t count = kMinRatingsPerUser + static_cast<std::size_t>(extra * share + rng.uniform());
+            if (count > maxPerUser) count = maxPerUser;
+
+            picked.clear();
+            for (std::size_t tries = 0; picked.size() < count && tries < count * 50; ++tries) {
+                std::size_t r = popularity.sample(rng);
+                if (seen[r] == u + 1) continue;
+                seen[r] = u + 1;
+                picked.push_back(r);
+            }
+            sort_utils::quickSort(picked, [&](std::size_t a, std::size_t b) {
+                return byPopularity[a].id < byPopularity[b].id;
+            });
+
+            double bias = 0.4 * rng.normal();
+            std::int64_t time = 946684800 + static_cast<std::int64_t>(rng.below(18u * 365 * 86400));
+            for (std::size_t r : picked) {
+                const Movie& movie = byPopularity[r];
+                double rating = roundRating(movie.quality + bias + 0.9 * rng.normal(), rng);
+
+                out.number(u + 1);
+                out.put(',');
+                out.number(movie.id);
+                out.put(',');
+                // Sempre com uma casa, como no MovieLens ("4.0", "3.5")
+                int tenths = static_cast<int>(rating * 10.0 + 0.5);
+                out.number(tenths / 10);
+                out.put('.');
+                out.number(tenths % 10);
+                out.put(',');
+                out.number(time + static_cast<std::int64_t>(rng.below(3 * 86400)));
+                out.endLine();
+            }
+            written += picked.size();
+        }
+    }
+    if (std::fclose(file) != 0) {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+// tags.csv: userId,movieId,tag,timestamp
+bool writeTags(const std::string& path, const Sizes& sizes, const std::vector<Movie>& byPopularity,
+               Random& rng, std::string& error) {
+    std::FILE* file;
+    if (!openOutput(path, file, error)) return false;
+
+    std::size_t vocabularySize = kCommonTagCount + static_cast<std::size_t>(1500.0 * std::sqrt(sizes.tags / kBaseTags));
+    std::vector<std::string> vocabulary(kCommonTags, kCommonTags + kCommonTagCount);
+    std::vector<std::string> words = makeWords(vocabularySize, rng);
+    for (std::size_t i = 0; vocabulary.size() < vocabularySize; ++i) {
+        std::string tag = words[i];
+        if (rng.uniform() < 0.3) tag += " " + words[rng.below(words.size())];
+        vocabulary.push_back(tag);
+    }
+
+    ZipfSampler tagSampler(vocabulary.size(), 2.0, 1.0);
+    ZipfSampler popularity(byPopularity.size(), kPopularityOffset, 1.0);
+    std::size_t taggers = static_cast<std::size_t>(sizes.users * kTaggerFraction) + 1;
+    ZipfSampler taggerSampler(taggers, 1.0, 1.0);
+    std::vector<std::size_t> taggerIds = shuffled(sizes.users, rng);
+
+    {
+        CsvWriter out(file);
+        out.text("userId,movieId,tag,timestamp");
+        out.endLine();
+
+        for (std::size_t t = 0; t < sizes.tags; ++t) {
+            std::string tag = vocabulary[tagSampler.sample(rng)];
+            // Variações que a carga normaliza (minúsculas e trim)
+            double style = rng.uniform();
+            if (style < 0.15) tag = capitalized(tag);
+            else if (style < 0.18) tag = " " + tag + " ";
+
+            out.number(taggerIds[taggerSampler.sample(rng)] + 1);
+            out.put(',');
+            out.number(byPopularity[popularity.sample(rng)].id);
+            out.put(',');
+            out.text(tag);
+            out.put(',');
+            out.number(1137000000 + static_cast<std::int64_t>(rng.below(12u * 365 * 86400)));
+            out.endLine();
+        }
+    }
+    if (std::fclose(file) != 0) {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+void usage(const char* argv0) {
+    std::fprintf(stderr, "usage: %s [--scale S] [--seed N] DIR\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    double scale = 1.0;
+    std::uint64_t seed = 42;
+    std::string dir;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--scale" && i + 1 < argc) {
+            scale = std::atof(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!arg.empty() && arg[0] != '-' && dir.empty()) {
+            dir = arg;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (dir.empty() || !(scale > 0.0)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    Sizes sizes;
+    sizes.ratings = static_cast<std::size_t>(kBaseRatings * scale);
+    // Escalas muito pequenas ainda geram pelo menos um usuário e um filme
+    sizes.users = static_cast<std::size_t>(kBaseUsers * scale);
+    sizes.movies = static_cast<std::size_t>(kBaseMovies * std::sqrt(scale));
+    if (sizes.users == 0) sizes.users = 1;
+    if (sizes.movies == 0) sizes.movies = 1;
+    sizes.tags = static_cast<std::size_t>(kBaseTags * scale);
+
+    // Cada arquivo com a sua sequência: mudar um não muda os outros
+    Random movieRng(seed), ratingRng(seed * 31 + 1), tagRng(seed * 31 + 2);
+    std::vector<Movie> byPopularity;
+    std::size_t ratings = 0;
+    std::string error;
+    if (!writeMovies(dir + "/movies.csv", sizes.movies, movieRng, byPopularity, error) ||
+        !writeRatings(dir + "/ratings.csv", sizes, byPopularity, ratingRng, ratings, error) ||
+        !writeTags(dir + "/tags.csv", sizes, byPopularity, tagRng, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    std::printf("scale %g: %zu movies, %zu users, %zu ratings, %zu tags in %s\n",
+                scale, sizes.movies, sizes.users, ratings, sizes.tags, dir.c_str());
+    return 0;
+}
@@ -0,0 +1,198 @@
+// Gerador de carga para o servidor de consultas.
+//
+// Abre C conexões, uma thread cada. Cada conexão manda N comandos tirados do arquivo em
+// rodízio (cada uma começa em um ponto diferente) e mantém até D pedidos sem resposta
+// (pipelining). A latência de um pedido vai do envio da linha até a chegada do "." que
+// fecha a sua resposta. No fim imprime a vazão e os percentis de latência.
+//
+// D fica limitado a 64, o máximo de comandos em andamento que o servidor aceita por conexão;
+// acima disso o servidor para de ler e o envio bloquearia sem ninguém lendo as respostas.
+//
+// Uso:
+//   loadgen (--unix PATH | --tcp PORT) [--connections C] [--depth D] [--requests N] comandos.txt
+//
+// Compilar (na raiz do projeto):
+//   g++ -std=c++17 -O2 -pthread -Iinclude tools/loadgen.cpp -o loadgen
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "connect.hpp"
+#include "sort_utils.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::size_t kMaxDepth = 64;
+
+struct Config {
+    std::string unixPath;
+    int tcpPort = -1;
+    std::size_t connections = 4;
+    std::size_t depth = 8;
+    std::size_t requests = 10000;  // por conexão
+    std::string commandsPath;
+};
+
+struct Result {
+    std::vector<double> latencies;  // microssegundos, um por pedido respondido
+    std::size_t bytes = 0;
+    std::string error;
+};
+
+void usage(const char* argv0) {
+    std::fprintf(stderr,
+                 "usage: %s (--unix PATH | --tcp PORT) [--connections C] [--depth D] [--requests N] commands\n",
+                 argv0);
+}
+
+bool parseArgs(int argc, char** argv, Config& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--unix" && hasValue) {
+            config.unixPath = argv[++i];
+        } else if (arg == "--tcp" && hasValue) {
+            config.tcpPort = std::atoi(argv[++i]);
+        } else if (arg == "--connections" && hasValue) {
+            config.connections = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--depth" && hasValue) {
+            config.depth = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--requests" && hasValue) {
+            config.requests = std::strtoul(argv[++i], nullptr, 10);
+        } else if (!arg.empty() && arg[0] != '-' && config.commandsPath.empty()) {
+            config.commandsPath = arg;
+        } else {
+            return false;
+        }
+    }
+    if (config.unixPath.empty() == (config.tcpPort < 0)) return false;
+    if (config.commandsPath.empty() || config.connections == 0 || config.depth == 0) return false;
+    if (config.depth > kMaxDepth) config.depth = kMaxDepth;
+    return true;
+}
+
+// Uma conexão: manda os pedidos mantendo até depth sem resposta e mede cada um
+void runConnection(const Config& config, const std::vector<std::string>& commands,
+                   std::size_t first, Result& result) {
+    int fd = connectToServer(config.unixPath, config.tcpPort, result.error);
+    if (fd < 0) return;
+
+    // Horário de envio dos pedidos sem resposta, em fila circular
+    std::vector<Clock::time_point> sentAt(config.depth);
+    std::size_t sent = 0, answered = 0;
+    result.latencies.reserve(config.requests);
+
+    // Estado da busca pela linha "." que fecha cada resposta
+    bool atLineStart = true, sawDot = false;
+    char buf[64 * 1024];
+
+    while (answered < config.requests) {
+        while (sent < config.requests && sent - answered < config.depth) {
+            const std::string& line = commands[(first + sent) % commands.size()];
+            sentAt[sent % config.depth] = Clock::now();
+            if (!writeAll(fd, line.data(), line.size())) {
+                result.error = "connection closed while sending";
+                ::close(fd);
+                return;
+            }
+            ++sent;
+        }
+
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            result.error = "connection closed with " + std::to_string(sent - answered) + " requests pending";
+            break;
+        }
+        Clock::time_point now = Clock::now();
+        result.bytes += static_cast<std::size_t>(n);
+
+        for (ssize_t i = 0; i < n; ++i) {
+            char c = buf[i];
+            if (c == '\n') {
+                if (sawDot) {
+                    std::chrono::duration<double, std::micro> waited = now - sentAt[answered % config.depth];
+                    result.latencies.push_back(waited.count());
+                    ++answered;
+                }
+                atLineStart = true;
+                sawDot = false;
+            } else {
+                sawDot = atLineStart && c == '.';
+                atLineStart = false;
+            }
+        }
+    }
+    ::close(fd);
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    std::size_t i = static_cast<std::size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[i];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Config config;
+    if (!parseArgs(argc, argv, config)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<std::string> commands;
+    std::ifstream in(config.commandsPath);
+    if (!in) {
+        std::fprintf(stderr, "cannot open %s\n", config.commandsPath.c_str());
+        return 1;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        commands.push_back(line + '\n');
+    }
+    if (commands.empty()) {
+        std::fprintf(stderr, "no commands in %s\n", config.commandsPath.c_str());
+        return 1;
+    }
+
+    std::vector<Result> results(config.connections);
+    std::vector<std::thread> threads;
+    Clock::time_point start = Clock::now();
+    for (std::size_t c = 0; c < config.connections; ++c) {
+        std::size_t first = c * commands.size() / config.connections;
+        threads.emplace_back(runConnection, std::cref(config), std::cref(commands), first, std::ref(results[c]));
+    }
+    for (std::thread& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> latencies;
+    std::size_t bytes = 0;
+    int failed = 0;
+    for (const Result& r : results) {
+        latencies.insert(latencies.end(), r.latencies.begin(), r.latencies.end());
+        bytes += r.bytes;
+        if (!r.error.empty()) {
+            std::fprintf(stderr, "%s\n", r.error.c_str());
+            ++failed;
+        }
+    }
+    sort_utils::quickSort(latencies, [](double a, double b) { return a < b; });
+
+    std::printf("%zu connections, depth %zu: %zu requests in %.2f s (%.0f req/s, %.1f MiB received)\n",
+                config.connections, config.depth, latencies.size(), seconds,
+                latencies.size() / seconds, bytes / (1024.0 * 1024.0));
+    std::printf("latency us: p50 %.0f  p95 %.0f  p99 %.0f  max %.0f\n",
+                percentile(latencies, 0.50), percentile(latencies, 0.95),
+                percentile(latencies, 0.99), latencies.empty() ? 0.0 : latencies.back());
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+// Cliente do servidor de consultas (--serve-unix / --serve-tcp).
+//
+// Manda as linhas do stdin sem esperar as respostas (uma thread só para o envio) e imprime as
+// respostas na ordem, sem a linha "." que termina cada uma; a saída fica igual à do modo
+// stdin. Depois do stdin acabar fecha o lado de escrita e sai quando o servidor terminar de
+// responder.
+//
+// Uso:
+//   ms_client --unix PATH < comandos.txt
+//   ms_client --tcp PORT < comandos.txt
+//
+// Compilar (na raiz do projeto):
+//   g++ -std=c++17 -O2 -pthread tools/ms_client.cpp -o ms_client
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "connect.hpp"
+
+namespace {
+
+void usage(const char* argv0) {
+    std::fprintf(stderr, "usage: %s (--unix PATH | --tcp PORT) < commands\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string unixPath;
+    int tcpPort = -1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--unix" && i + 1 < argc) {
+            unixPath = argv[++i];
+        } else if (arg == "--tcp" && i + 1 < argc) {
+            tcpPort = std::atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (unixPath.empty() == (tcpPort < 0)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::string error;
+    int fd = connectToServer(unixPath, tcpPort, error);
+    if (fd < 0) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    std::thread sender([fd] {
+        char buf[64 * 1024];
+        std::size_t n;
+        while ((n = std::fread(buf, 1, sizeof(buf), stdin)) > 0) {
+            if (!writeAll(fd, buf, n)) break;
+        }
+        ::shutdown(fd, SHUT_WR);
+    });
+
+    // Copia as linhas, menos as "." que separam as respostas
+    std::string line;
+    char buf[64 * 1024];
+    ssize_t n;
+    while ((n = ::recv(fd, buf, sizeof(buf), 0)) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::perror("recv");
+            break;
+        }
+        for (ssize_t i = 0; i < n; ++i) {
+            line.push_back(buf[i]);
+            if (buf[i] != '\n') continue;
+            if (line != ".\n") std::fwrite(line.data(), 1, line.size(), stdout);
+            line.clear();
+        }
+    }
+    std::fwrite(line.data(), 1, line.size(), stdout);
+    std::fflush(stdout);
+
+    sender.join();
+    ::close(fd);
+    return 0;
+}